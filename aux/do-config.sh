@@ -11,4 +11,5 @@ cmake \
  -D GOAL_OPTIMIZE=ON \
  -D GOAL_SYMBOLS=ON \
  -D GOAL_DISABLE_CHECKS=OFF \
+ -D GOAL_MIXED_PRECISION=OFF \
 ..
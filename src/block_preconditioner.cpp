@@ -0,0 +1,219 @@
+#include "block_preconditioner.hpp"
+#include "control.hpp"
+
+#include <Ifpack2_Factory.hpp>
+#include <TpetraExt_MatrixMatrix.hpp>
+
+#include <map>
+
+namespace goal {
+
+typedef Tpetra::RowMatrix<ST, LO, GO, KNode> RM;
+typedef Ifpack2::Preconditioner<ST, LO, GO, KNode> IfpackPrec;
+
+static bool in_block(GO gid, unsigned num_eqs, unsigned offset)
+{
+  return (gid % num_eqs) == offset;
+}
+
+static RCP<const Map> get_block_map(
+    RCP<const Map> m,
+    unsigned num_eqs,
+    unsigned offset,
+    unsigned block)
+{
+  Teuchos::ArrayView<const GO> gids = m->getNodeElementList();
+  Teuchos::Array<GO> indices;
+  for (unsigned i=0; i < gids.size(); ++i)
+    if (in_block(gids[i], num_eqs, offset) == (block == 1))
+      indices.push_back(gids[i]);
+  return Tpetra::createNonContigMap<LO,GO>(indices, m->getComm());
+}
+
+static RCP<Matrix> extract_block(
+    RCP<Matrix> A,
+    RCP<const Map> rows,
+    RCP<const Map> cols,
+    unsigned num_eqs,
+    unsigned offset,
+    unsigned col_block)
+{
+  size_t max_entries = A->getNodeMaxNumRowEntries();
+  RCP<Matrix> B = rcp(new Matrix(rows, max_entries));
+  Teuchos::Array<GO> indices(max_entries);
+  Teuchos::Array<ST> entries(max_entries);
+  Teuchos::Array<GO> block_indices;
+  Teuchos::Array<ST> block_entries;
+  Teuchos::ArrayView<const GO> gids = rows->getNodeElementList();
+  for (unsigned i=0; i < gids.size(); ++i) {
+    size_t num_entries;
+    A->getGlobalRowCopy(gids[i], indices(), entries(), num_entries);
+    block_indices.resize(0);
+    block_entries.resize(0);
+    for (size_t j=0; j < num_entries; ++j) {
+      if (in_block(indices[j], num_eqs, offset) == (col_block == 1)) {
+        block_indices.push_back(indices[j]);
+        block_entries.push_back(entries[j]);
+      }
+    }
+    if (block_indices.size() > 0)
+      B->insertGlobalValues(gids[i], block_indices(), block_entries());
+  }
+  B->fillComplete(cols, rows);
+  return B;
+}
+
+/* inv(diag(A)), with unit entries where the diagonal vanishes */
+static RCP<Vector> get_inverse_diagonal(RCP<Matrix> A)
+{
+  RCP<Vector> d = rcp(new Vector(A->getRowMap()));
+  A->getLocalDiagCopy(*d);
+  Teuchos::ArrayRCP<ST> v = d->get1dViewNonConst();
+  for (Teuchos_Ordinal i=0; i < v.size(); ++i)
+    v[i] = (v[i] != 0.0) ? 1.0/v[i] : 1.0;
+  return d;
+}
+
+/* rows of A scaled by the entries of s, which share the row map */
+static RCP<Matrix> scale_rows(RCP<Matrix> A, RCP<const Vector> s)
+{
+  size_t max_entries = A->getNodeMaxNumRowEntries();
+  RCP<Matrix> B = rcp(new Matrix(A->getRowMap(), max_entries));
+  Teuchos::Array<GO> indices(max_entries);
+  Teuchos::Array<ST> entries(max_entries);
+  Teuchos::ArrayRCP<const ST> v = s->get1dView();
+  Teuchos::ArrayView<const GO> gids = A->getRowMap()->getNodeElementList();
+  for (unsigned i=0; i < gids.size(); ++i) {
+    size_t num_entries;
+    A->getGlobalRowCopy(gids[i], indices(), entries(), num_entries);
+    for (size_t j=0; j < num_entries; ++j)
+      entries[j] *= v[i];
+    if (num_entries > 0)
+      B->insertGlobalValues(
+          gids[i], indices(0, num_entries), entries(0, num_entries));
+  }
+  B->fillComplete(A->getDomainMap(), A->getRangeMap());
+  return B;
+}
+
+/* the row by row difference A - B of matrices on the same row map */
+static RCP<Matrix> subtract(RCP<Matrix> A, RCP<Matrix> B)
+{
+  size_t max_entries =
+    A->getNodeMaxNumRowEntries() + B->getNodeMaxNumRowEntries();
+  RCP<Matrix> C = rcp(new Matrix(A->getRowMap(), max_entries));
+  Teuchos::Array<GO> indices(max_entries);
+  Teuchos::Array<ST> entries(max_entries);
+  Teuchos::ArrayView<const GO> gids = A->getRowMap()->getNodeElementList();
+  for (unsigned i=0; i < gids.size(); ++i) {
+    std::map<GO, ST> row;
+    size_t num_entries;
+    A->getGlobalRowCopy(gids[i], indices(), entries(), num_entries);
+    for (size_t j=0; j < num_entries; ++j)
+      row[indices[j]] += entries[j];
+    B->getGlobalRowCopy(gids[i], indices(), entries(), num_entries);
+    for (size_t j=0; j < num_entries; ++j)
+      row[indices[j]] -= entries[j];
+    Teuchos::Array<GO> cols;
+    Teuchos::Array<ST> vals;
+    std::map<GO, ST>::iterator it;
+    for (it = row.begin(); it != row.end(); ++it) {
+      cols.push_back(it->first);
+      vals.push_back(it->second);
+    }
+    if (cols.size() > 0)
+      C->insertGlobalValues(gids[i], cols(), vals());
+  }
+  C->fillComplete(A->getDomainMap(), A->getRangeMap());
+  return C;
+}
+
+/* the approximate schur complement S = A11 - A10 inv(diag(A00)) A01
+   of the pressure block. the ilut of A11 alone ignores how strongly
+   the pressure couples through the displacements, while S keeps that
+   coupling at the cost of a diagonal approximation of inv(A00). */
+static RCP<Matrix> build_schur(
+    RCP<Matrix> A00,
+    RCP<Matrix> A01,
+    RCP<Matrix> A10,
+    RCP<Matrix> A11)
+{
+  RCP<Matrix> DA01 = scale_rows(A01, get_inverse_diagonal(A00));
+  RCP<Matrix> P = rcp(new Matrix(A10->getRowMap(), 0));
+  Tpetra::MatrixMatrix::Multiply(*A10, false, *DA01, false, *P);
+  return subtract(A11, P);
+}
+
+static RCP<Operator> build_block_inverse(
+    RCP<Matrix> A,
+    RCP<const ParameterList> p)
+{
+  Ifpack2::Factory factory;
+  RCP<IfpackPrec> prec = factory.create<RM>("ILUT", A);
+  prec->setParameters(*p);
+  prec->initialize();
+  prec->compute();
+  return prec;
+}
+
+BlockPreconditioner::BlockPreconditioner(
+    RCP<Matrix> A,
+    RCP<const ParameterList> p,
+    unsigned num_eqs,
+    unsigned offset)
+{
+  CHECK(offset < num_eqs);
+  map = A->getRowMap();
+  RCP<Matrix> Abb[2];
+  for (unsigned b=0; b < 2; ++b) {
+    block_maps[b] = get_block_map(map, num_eqs, offset, b);
+    importers[b] = rcp(new Import(map, block_maps[b]));
+    Abb[b] = extract_block(
+        A, block_maps[b], block_maps[b], num_eqs, offset, b);
+  }
+  coupling = extract_block(
+      A, block_maps[1], block_maps[0], num_eqs, offset, 0);
+  RCP<Matrix> A01 = extract_block(
+      A, block_maps[0], block_maps[1], num_eqs, offset, 1);
+  RCP<Matrix> S = build_schur(Abb[0], A01, coupling, Abb[1]);
+  inverses[0] = build_block_inverse(Abb[0], p);
+  inverses[1] = build_block_inverse(S, p);
+}
+
+RCP<const Map> BlockPreconditioner::getDomainMap() const
+{
+  return map;
+}
+
+RCP<const Map> BlockPreconditioner::getRangeMap() const
+{
+  return map;
+}
+
+/* y0 = inv(A00) x0
+   y1 = inv(S) (x1 - A10 y0) */
+void BlockPreconditioner::apply(
+    MultiVector const& X,
+    MultiVector& Y,
+    Teuchos::ETransp mode,
+    ST alpha,
+    ST beta) const
+{
+  CHECK(mode == Teuchos::NO_TRANS);
+  size_t nv = X.getNumVectors();
+  MultiVector x0(block_maps[0], nv);
+  MultiVector x1(block_maps[1], nv);
+  MultiVector y0(block_maps[0], nv);
+  MultiVector y1(block_maps[1], nv);
+  x0.doImport(X, *(importers[0]), Tpetra::INSERT);
+  x1.doImport(X, *(importers[1]), Tpetra::INSERT);
+  inverses[0]->apply(x0, y0);
+  coupling->apply(y0, x1, Teuchos::NO_TRANS, -1.0, 1.0);
+  inverses[1]->apply(x1, y1);
+  MultiVector Z(map, nv);
+  Z.doExport(y0, *(importers[0]), Tpetra::INSERT);
+  Z.doExport(y1, *(importers[1]), Tpetra::INSERT);
+  Y.update(alpha, Z, beta);
+}
+
+}
@@ -0,0 +1,50 @@
+#ifndef goal_block_preconditioner_hpp
+#define goal_block_preconditioner_hpp
+
+#include "data_types.hpp"
+
+namespace goal {
+
+using Teuchos::rcp;
+using Teuchos::RCP;
+using Teuchos::ParameterList;
+
+/* a 2x2 block lower triangular preconditioner for interleaved dofs.
+   dofs whose global id satisfies gid % num_eqs == offset form the
+   second block (the pressure), all others form the first block. the
+   second block is solved with the approximate schur complement
+   S = A11 - A10 inv(diag(A00)) A01. */
+
+class BlockPreconditioner : public Operator
+{
+  public:
+
+    BlockPreconditioner(
+        RCP<Matrix> A,
+        RCP<const ParameterList> sub_params,
+        unsigned num_eqs,
+        unsigned offset);
+
+    RCP<const Map> getDomainMap() const;
+    RCP<const Map> getRangeMap() const;
+
+    void apply(
+        MultiVector const& X,
+        MultiVector& Y,
+        Teuchos::ETransp mode = Teuchos::NO_TRANS,
+        ST alpha = Teuchos::ScalarTraits<ST>::one(),
+        ST beta = Teuchos::ScalarTraits<ST>::zero()) const;
+
+  private:
+
+    RCP<const Map> map;
+    RCP<const Map> block_maps[2];
+    RCP<Import> importers[2];
+    RCP<Matrix> coupling;
+    RCP<Operator> inverses[2];
+
+};
+
+}
+
+#endif
@@ -26,6 +26,7 @@ typedef Tpetra::Import<LO, GO, KNode> Import;
 typedef Tpetra::Vector<ST, LO, GO, KNode> Vector;
 typedef Tpetra::MultiVector<ST, LO, GO, KNode> MultiVector;
 typedef Tpetra::CrsMatrix<ST, LO, GO, KNode> Matrix;
+typedef Tpetra::Operator<ST, LO, GO, KNode> Operator;
 typedef Tpetra::MatrixMarket::Writer<Matrix> MM_Writer;
 
 }
@@ -7,6 +7,10 @@
 #include "assert_param.hpp"
 #include "control.hpp"
 
+#include <Tpetra_RowMatrixTransposer.hpp>
+
+#include <algorithm>
+
 namespace goal {
 
 static void validate_params(RCP<const ParameterList> p)
@@ -29,9 +33,24 @@ DualProblem::DualProblem(
   t_old(0.0),
   alpha(0.0),
   beta(0.0),
-  gamma(0.0)
+  gamma(0.0),
+  transpose_primal(false),
+  goal_tolerance(0.0)
 {
   validate_params(params);
+  if (params->isParameter("dual: transpose primal jacobian"))
+    transpose_primal = params->get<bool>("dual: transpose primal jacobian");
+  /* the assembled primal jacobian belongs to the last newton iterate,
+     which is the converged state only when the jacobian is constant */
+  if (transpose_primal && (! mechanics->is_linear())) {
+    print("dual: nonlinear model, the dual jacobian is assembled");
+    transpose_primal = false;
+  }
+  linear_solver = rcp(new LinearSolver(params));
+  linear_solver->set_nonzero_guess(true);
+  if (mechanics->is_mixed())
+    linear_solver->set_block_split(
+        mechanics->get_num_eqs(), mechanics->get_offset("p"));
 }
 
 struct DualInfo
@@ -59,6 +78,7 @@ void DualProblem::set_coeffs(double a, double b, double c)
 static void load_overlap_solution(Workset& ws, RCP<SolutionInfo> s)
 {
   ws.u = s->ovlp_solution;
+  ws.r = s->ovlp_residual;
   ws.q = s->ovlp_qoi;
   ws.J = s->ovlp_jacobian;
 }
@@ -88,17 +108,18 @@ static void load_mesh_info(
 {
   std::string const& set = m->get_elem_set_name(set_idx);
   ws.set = set;
+  ws.ws_idx = ws_idx;
   ws.ents = m->get_elems(set, ws_idx);
   ws.size = ws.ents.size();
 }
 
+template <typename D>
 static void compute_volumetric_jacobian(
     RCP<Mesh> m,
     RCP<Mechanics> mech,
     RCP<SolutionInfo> s,
     DualInfo* info)
 {
-  typedef GoalTraits::Derivative D;
   FieldManagers f = mech->get_volumetric();
   Workset ws;
   load_overlap_solution(ws, s);
@@ -116,17 +137,19 @@ static void compute_volumetric_jacobian(
   }
 }
 
+template <typename D>
 static void compute_dirichlet_jacobian(
     RCP<Mesh> m,
     RCP<Mechanics> mech,
     RCP<SolutionInfo> s,
+    RCP<Matrix> J,
     DualInfo* info)
 {
-  typedef GoalTraits::Derivative D;
   FieldManager f = mech->get_dirichlet();
   Workset ws;
   load_owned_solution(ws, s);
   load_dual_info(ws, info);
+  ws.J = J;
   std::vector<PHX::index_size_type> dd;
   dd.push_back(m->get_num_elem_dofs());
   f->setKokkosExtendedDataTypeDimensions<D>(dd);
@@ -138,6 +161,8 @@ void DualProblem::compute_jacobian()
 {
   double t0 = time();
   sol_info->scatter_solution();
+  sol_info->owned_residual->putScalar(0.0);
+  sol_info->ovlp_residual->putScalar(0.0);
   sol_info->owned_qoi->putScalar(0.0);
   sol_info->ovlp_qoi->putScalar(0.0);
   sol_info->owned_jacobian->resumeFill();
@@ -145,24 +170,87 @@ void DualProblem::compute_jacobian()
   sol_info->owned_jacobian->setAllToScalar(0.0);
   sol_info->ovlp_jacobian->setAllToScalar(0.0);
   DualInfo dual_info = {t_new,t_old,alpha,beta,gamma};
-  compute_volumetric_jacobian(mesh, mechanics, sol_info, &dual_info);
+  unsigned num_dofs = mesh->get_num_elem_dofs();
+  GOAL_DISPATCH_DERIVATIVE(num_dofs, compute_volumetric_jacobian,
+      mesh, mechanics, sol_info, &dual_info);
   sol_info->ovlp_jacobian->fillComplete();
+  sol_info->gather_residual();
   sol_info->gather_qoi();
   sol_info->gather_jacobian();
-  compute_dirichlet_jacobian(mesh, mechanics, sol_info, &dual_info);
+  GOAL_DISPATCH_DERIVATIVE(num_dofs, compute_dirichlet_jacobian,
+      mesh, mechanics, sol_info, sol_info->owned_jacobian, &dual_info);
   sol_info->owned_jacobian->fillComplete();
+  sol_info->primal_jacobian = false;
   double t1 = time();
   print("  jacobian transpose computed in %f seconds", t1-t0);
 }
 
+bool DualProblem::reuses_primal_jacobian()
+{
+  return transpose_primal && sol_info->primal_jacobian;
+}
+
+/* the primal jacobian is still assembled when the dual is solved on
+   the primal discretization of a linear model, so it is transposed
+   explicitly and only the qoi derivative is assembled. the dirichlet
+   rows are eliminated from the transpose as they are from the
+   assembled transpose. */
+void DualProblem::compute_transpose()
+{
+  double t0 = time();
+  sol_info->scatter_solution();
+  sol_info->owned_qoi->putScalar(0.0);
+  sol_info->ovlp_qoi->putScalar(0.0);
+  DualInfo dual_info = {t_new,t_old,alpha,beta,gamma};
+  unsigned num_dofs = mesh->get_num_elem_dofs();
+  GOAL_DISPATCH_DERIVATIVE(num_dofs, compute_volumetric_jacobian,
+      mesh, mechanics, sol_info, &dual_info);
+  sol_info->gather_qoi();
+  Tpetra::RowMatrixTransposer<ST, LO, GO, KNode> transposer(
+      sol_info->owned_jacobian);
+  transpose = transposer.createTranspose();
+  transpose->resumeFill();
+  GOAL_DISPATCH_DERIVATIVE(num_dofs, compute_dirichlet_jacobian,
+      mesh, mechanics, sol_info, transpose, &dual_info);
+  transpose->fillComplete();
+  double t1 = time();
+  print("  primal jacobian transposed in %f seconds", t1-t0);
+}
+
+/* the dual residual is held to the absolute bound the goal solver
+   gives the newton residual. each column is measured against its own
+   ||q_i||, so the largest one sets the relative tolerance. */
+static double get_forcing(
+    RCP<const ParameterList> p,
+    double tol,
+    RCP<const MultiVector> q)
+{
+  if (tol <= 0.0) return 0.0;
+  Teuchos::Array<double> norms(q->getNumVectors());
+  q->norm2(norms());
+  double max_norm = 0.0;
+  for (unsigned i=0; i < norms.size(); ++i)
+    max_norm = std::max(max_norm, norms[i]);
+  if (max_norm <= 0.0) return 0.0;
+  double min_tol = p->get<double>("linear: tolerance");
+  return std::min(0.1, std::max(min_tol, tol / max_norm));
+}
+
 void DualProblem::solve()
 {
   print("solving dual model");
-  compute_jacobian();
-  RCP<Vector> z = sol_info->owned_dual;
-  RCP<Vector> q = sol_info->owned_qoi;
   RCP<Matrix> J = sol_info->owned_jacobian;
-  solve_linear_system(params, J, z, q);
+  if (reuses_primal_jacobian()) {
+    compute_transpose();
+    J = transpose;
+  }
+  else
+    compute_jacobian();
+  RCP<MultiVector> z = sol_info->owned_dual;
+  RCP<MultiVector> q = sol_info->owned_qoi;
+  linear_solver->set_tolerance(get_forcing(params, goal_tolerance, q));
+  linear_solver->set_coarse_map(mesh->get_vertex_map());
+  linear_solver->solve(J, z, q);
 }
 
 RCP<DualProblem> dual_create(
@@ -1,6 +1,8 @@
 #ifndef goal_dual_problem_hpp
 #define goal_dual_problem_hpp
 
+#include "data_types.hpp"
+
 #include <Teuchos_RCP.hpp>
 
 namespace Teuchos {
@@ -16,6 +18,7 @@ using Teuchos::ParameterList;
 class Mesh;
 class Mechanics;
 class SolutionInfo;
+class LinearSolver;
 
 class DualProblem
 {
@@ -33,12 +36,18 @@ class DualProblem
 
     void solve();
 
+    bool reuses_primal_jacobian();
+
+    void set_goal_tolerance(double t) {goal_tolerance = t;}
+
   private:
 
     RCP<const ParameterList> params;
     RCP<Mesh> mesh;
     RCP<Mechanics> mechanics;
     RCP<SolutionInfo> sol_info;
+    RCP<LinearSolver> linear_solver;
+    RCP<Matrix> transpose;
 
     double t_new;
     double t_old;
@@ -47,7 +56,11 @@ class DualProblem
     double beta;
     double gamma;
 
+    bool transpose_primal;
+    double goal_tolerance;
+
     void compute_jacobian();
+    void compute_transpose();
 
 };
 
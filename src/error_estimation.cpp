@@ -7,6 +7,8 @@
 #include "assert_param.hpp"
 #include "control.hpp"
 
+#include <cmath>
+
 namespace goal {
 
 ErrorEstimation::ErrorEstimation(
@@ -52,6 +54,7 @@ static void load_mesh_info(
 {
   std::string const& set = m->get_elem_set_name(set_idx);
   ws.set = set;
+  ws.ws_idx = ws_idx;
   ws.ents = m->get_elems(set, ws_idx);
   ws.size = ws.ents.size();
 }
@@ -78,6 +81,8 @@ static void compute_volumetric_error(
   }
 }
 
+/* the error is localized in the sum of the qois, see GatherDual.
+   estimate gives the error in each qoi separately. */
 void ErrorEstimation::localize()
 {
   double t0 = time();
@@ -89,6 +94,17 @@ void ErrorEstimation::localize()
   print("error localized in %f seconds", t1-t0);
 }
 
+/* the dual weighted residual estimate of the error in qoi i.
+   the residual of the primal solution in the dual space is assembled
+   with the dual jacobian, so this must be called before localize. */
+double ErrorEstimation::estimate(unsigned i)
+{
+  RCP<const Vector> z = sol_info->owned_dual->getVector(i);
+  double eta = std::abs(z->dot(*(sol_info->owned_residual)));
+  print("estimated error in qoi %u: %e", i, eta);
+  return eta;
+}
+
 RCP<ErrorEstimation> error_create(
     RCP<const ParameterList> p,
     RCP<Mesh> m,
@@ -31,6 +31,8 @@ class ErrorEstimation
 
     void localize();
 
+    double estimate(unsigned i);
+
   private:
 
     RCP<const ParameterList> params;
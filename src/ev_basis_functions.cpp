@@ -4,6 +4,7 @@
 #include "workset.hpp"
 #include "traits.hpp"
 #include "phx_utils.hpp"
+#include "control.hpp"
 
 #include <apf.h>
 #include <apfMesh2.h>
@@ -38,8 +39,40 @@ PHX_POST_REGISTRATION_SETUP(BasisFunctions, data, fm)
   this->utils.setFieldData(gBF, fm);
 }
 
+static void copy_from_cache(
+    BasisCache const& c,
+    unsigned num_elems,
+    unsigned num_nodes,
+    unsigned num_qps,
+    unsigned num_dims,
+    PHX::MDField<double, Elem, QP>& wDv,
+    PHX::MDField<double, Elem, Node, QP>& BF,
+    PHX::MDField<double, Elem, Node, QP, Dim>& gBF)
+{
+  for (unsigned elem=0; elem < num_elems; ++elem) {
+    for (unsigned qp=0; qp < num_qps; ++qp)
+      wDv(elem, qp) = c.wDv[elem*num_qps + qp];
+    for (unsigned node=0; node < num_nodes; ++node) {
+      for (unsigned qp=0; qp < num_qps; ++qp) {
+        unsigned idx = (elem*num_nodes + node)*num_qps + qp;
+        BF(elem, node, qp) = c.BF[idx];
+        for (unsigned dim=0; dim < num_dims; ++dim)
+          gBF(elem, node, qp, dim) = c.gBF[idx*num_dims + dim];
+      }
+    }
+  }
+}
+
 PHX_EVALUATE_FIELDS(BasisFunctions, workset)
 {
+  if (mesh->has_basis_cache()) {
+    BasisCache const& c = mesh->get_basis_cache(workset.set, workset.ws_idx);
+    CHECK(c.wDv.size() == workset.size*num_qps);
+    copy_from_cache(
+        c, workset.size, num_nodes, num_qps, num_dims, wDv, BF, gBF);
+    return;
+  }
+
   apf::Mesh* m = mesh->get_apf_mesh();
   apf::FieldShape* s = mesh->get_apf_shape();
 
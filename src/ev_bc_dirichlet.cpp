@@ -121,8 +121,8 @@ evaluateFields(typename Traits::EvalData workset)
   }
 }
 
-template <typename Traits>
-void BCDirichlet<GoalTraits::Derivative, Traits>::
+template <int N, typename Traits>
+void BCDirichlet<GoalTraits::DerivativeN<N>, Traits>::
 validate_params()
 {
   using Teuchos::Array;
@@ -141,8 +141,8 @@ validate_params()
   }
 }
 
-template <typename Traits>
-BCDirichlet<GoalTraits::Derivative, Traits>::
+template <int N, typename Traits>
+BCDirichlet<GoalTraits::DerivativeN<N>, Traits>::
 BCDirichlet(ParameterList const& p) :
   dl        (p.get<RCP<Layouts> >("Layouts")),
   mesh      (p.get<RCP<Mesh> >("Mesh")),
@@ -150,6 +150,7 @@ BCDirichlet(ParameterList const& p) :
   params    (p.get<RCP<const ParameterList> >("DBC Parameters"))
 {
   validate_params();
+  symmetric = mechanics->is_symmetric_dirichlet();
 
   std::string name = "Dirichlet BCs";
   PHX::Tag<ScalarT> op(name, dl->dummy);
@@ -157,16 +158,16 @@ BCDirichlet(ParameterList const& p) :
   this->addEvaluatedField(op);
 }
 
-template <typename Traits>
-void BCDirichlet<GoalTraits::Derivative, Traits>::
+template <int N, typename Traits>
+void BCDirichlet<GoalTraits::DerivativeN<N>, Traits>::
 postRegistrationSetup(
     typename Traits::SetupData d,
     PHX::FieldManager<Traits>& fm)
 {
 }
 
-template <typename Traits>
-void BCDirichlet<GoalTraits::Derivative, Traits>::
+template <int N, typename Traits>
+void BCDirichlet<GoalTraits::DerivativeN<N>, Traits>::
 apply_bc(
     typename Traits::EvalData workset,
     Teuchos::Array<std::string> const& a)
@@ -182,7 +183,7 @@ apply_bc(
 
   ArrayRCP<const ST> sol;
   ArrayRCP<ST> res;
-  ArrayRCP<ST> qoi;
+  ArrayRCP<ArrayRCP<ST> > qoi;
 
   if (fill_res) {
     CHECK(workset.u != Teuchos::null);
@@ -196,7 +197,7 @@ apply_bc(
 
   if (fill_qoi) {
     CHECK(workset.q != Teuchos::null);
-    qoi = workset.q->get1dViewNonConst();
+    qoi = workset.q->get2dViewNonConst();
     CHECK(qoi != Teuchos::null);
   }
 
@@ -212,6 +213,13 @@ apply_bc(
   double t = workset.t_new;
   std::vector<apf::Node*> const& nodes = mesh->get_nodes(set);
 
+  ArrayRCP<ST> m;
+  ArrayRCP<ST> g;
+  if (symmetric) {
+    m = mask->get1dViewNonConst();
+    g = lift->get1dViewNonConst();
+  }
+
   for (unsigned i=0; i < nodes.size(); ++i) {
 
     apf::Node* node = nodes[i];
@@ -223,7 +231,14 @@ apply_bc(
     }
 
     if (fill_qoi)
-      qoi[row] = 0.0;
+      for (unsigned j=0; j < qoi.size(); ++j)
+        qoi[j][row] = 0.0;
+
+    if (symmetric) {
+      m[row] = 1.0;
+      if (fill_res) g[row] = res[row];
+      continue;
+    }
 
     index[0] = row;
     num_entries = J->getNumEntriesInLocalRow(row);
@@ -237,8 +252,53 @@ apply_bc(
   }
 }
 
-template <typename Traits>
-void BCDirichlet<GoalTraits::Derivative, Traits>::
+/* with every constrained row marked, make a single pass over the
+   local matrix. constrained rows become identity rows, and the
+   constrained columns of the free rows are zeroed after their
+   contribution J_ic (u_c - v_c) is moved to the residual, so the
+   update is unchanged and a symmetric jacobian stays symmetric. */
+template <int N, typename Traits>
+void BCDirichlet<GoalTraits::DerivativeN<N>, Traits>::
+eliminate_columns(typename Traits::EvalData workset)
+{
+  RCP<Matrix> J = workset.J;
+  RCP<const Map> row_map = J->getRowMap();
+  RCP<const Map> col_map = J->getColMap();
+  RCP<const Import> importer = J->getCrsGraph()->getImporter();
+  if (importer == Teuchos::null)
+    importer = rcp(new Import(J->getDomainMap(), col_map));
+  Vector col_mask(col_map);
+  Vector col_lift(col_map);
+  col_mask.doImport(*mask, *importer, Tpetra::INSERT);
+  col_lift.doImport(*lift, *importer, Tpetra::INSERT);
+
+  bool fill_res = (workset.r != Teuchos::null);
+  ArrayRCP<ST> res;
+  if (fill_res) res = workset.r->get1dViewNonConst();
+  ArrayRCP<const ST> row_m = mask->get1dView();
+  ArrayRCP<const ST> m = col_mask.get1dView();
+  ArrayRCP<const ST> g = col_lift.get1dView();
+
+  typename Matrix::local_matrix_type A = J->getLocalMatrix();
+  LO num_rows = row_map->getNodeNumElements();
+  for (LO row=0; row < num_rows; ++row) {
+    GO grow = row_map->getGlobalElement(row);
+    bool constrained = (row_m[row] > 0.0);
+    for (size_t k=A.graph.row_map(row); k < A.graph.row_map(row+1); ++k) {
+      LO col = A.graph.entries(k);
+      if (constrained) {
+        A.values(k) = (col_map->getGlobalElement(col) == grow) ? 1.0 : 0.0;
+      }
+      else if (m[col] > 0.0) {
+        if (fill_res) res[row] -= A.values(k) * g[col];
+        A.values(k) = 0.0;
+      }
+    }
+  }
+}
+
+template <int N, typename Traits>
+void BCDirichlet<GoalTraits::DerivativeN<N>, Traits>::
 evaluateFields(typename Traits::EvalData workset)
 {
   using Teuchos::Array;
@@ -246,11 +306,19 @@ evaluateFields(typename Traits::EvalData workset)
   using Teuchos::ParameterEntry;
   using Teuchos::getValue;
 
+  if (symmetric) {
+    mask = rcp(new Vector(workset.J->getRowMap()));
+    lift = rcp(new Vector(workset.J->getRowMap()));
+  }
+
   for (auto i=this->params->begin(); i != this->params->end(); ++i) {
     ParameterEntry const& entry = this->params->entry(i);
     Array<std::string> a = getValue<Array<std::string> >(entry);
     this->template apply_bc(workset, a);
   }
+
+  if (symmetric)
+    eliminate_columns(workset);
 }
 
 GOAL_INSTANTIATE_ALL(BCDirichlet)
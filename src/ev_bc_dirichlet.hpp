@@ -45,10 +45,10 @@ class BCDirichlet<GoalTraits::Forward, Traits> :
         Teuchos::Array<std::string> const& a);
 };
 
-template <typename Traits>
-class BCDirichlet<GoalTraits::Derivative, Traits> :
+template <int N, typename Traits>
+class BCDirichlet<GoalTraits::DerivativeN<N>, Traits> :
   public PHX::EvaluatorWithBaseImpl<Traits>,
-  public PHX::EvaluatorDerived<GoalTraits::Derivative, Traits>
+  public PHX::EvaluatorDerived<GoalTraits::DerivativeN<N>, Traits>
 {
   public:
 
@@ -62,19 +62,25 @@ class BCDirichlet<GoalTraits::Derivative, Traits> :
 
   private:
 
-    typedef typename GoalTraits::Derivative::ScalarT ScalarT;
+    typedef typename GoalTraits::DerivativeN<N>::ScalarT ScalarT;
 
     RCP<Layouts> dl;
     RCP<Mesh> mesh;
     RCP<Mechanics> mechanics;
     RCP<const ParameterList> params;
 
+    bool symmetric;
+    RCP<Vector> mask;
+    RCP<Vector> lift;
+
     void validate_params();
 
     void apply_bc(
         typename Traits::EvalData d,
         Teuchos::Array<std::string> const& a);
 
+    void eliminate_columns(typename Traits::EvalData d);
+
 };
 
 }
@@ -3,6 +3,8 @@
 #include "workset.hpp"
 #include "layouts.hpp"
 #include "phx_utils.hpp"
+#include "kernel_sizes.hpp"
+#include "parallel_elems.hpp"
 
 namespace goal {
 
@@ -53,19 +55,30 @@ PHX_POST_REGISTRATION_SETUP(DOFInterpolation, data, fm)
   }
 }
 
-PHX_EVALUATE_FIELDS(DOFInterpolation, workset)
+template <typename EvalT, typename Traits>
+template <unsigned N, unsigned Q, unsigned D>
+void DOFInterpolation<EvalT, Traits>::interpolate(unsigned ws_size)
 {
-  for (unsigned elem=0; elem < workset.size; ++elem) {
-  for (unsigned qp=0; qp < num_qps; ++qp) {
+  unsigned const nn = kernel_size<N>(num_nodes);
+  unsigned const nq = kernel_size<Q>(num_qps);
+  unsigned const nd = kernel_size<D>(num_dims);
+  parallel_elems(ws_size, [=] (int elem) {
+  for (unsigned qp=0; qp < nq; ++qp) {
   for (unsigned eq=0; eq < num_eqs; ++eq) {
     dofs[eq](elem,qp) = nodal[eq](elem,0) * BF(elem,0,qp);
-    for (unsigned node=1; node < num_nodes; ++node)
+    for (unsigned node=1; node < nn; ++node)
       dofs[eq](elem, qp) += nodal[eq](elem, node) * BF(elem,node,qp);
-    for (unsigned dim=0; dim < num_dims; ++dim) {
+    for (unsigned dim=0; dim < nd; ++dim) {
       gdofs[eq](elem,qp,dim) = nodal[eq](elem,0) * gBF(elem,0,qp,dim);
-      for (unsigned node=1; node < num_nodes; ++node)
+      for (unsigned node=1; node < nn; ++node)
         gdofs[eq](elem,qp,dim) += nodal[eq](elem,node) * gBF(elem,node,qp,dim);
-  }}}}
+  }}}});
+}
+
+PHX_EVALUATE_FIELDS(DOFInterpolation, workset)
+{
+  GOAL_DISPATCH_KERNEL(num_nodes, num_qps, num_dims,
+      this->template interpolate, workset.size);
 }
 
 GOAL_INSTANTIATE_ALL(DOFInterpolation)
@@ -30,6 +30,9 @@ PHX_EVALUATOR_CLASS(DOFInterpolation)
     std::vector<PHX::MDField<ScalarT, Elem, QP> > dofs;
     std::vector<PHX::MDField<ScalarT, Elem, QP, Dim> > gdofs;
 
+    template <unsigned N, unsigned Q, unsigned D>
+    void interpolate(unsigned ws_size);
+
 PHX_EVALUATOR_CLASS_END
 
 }
@@ -3,6 +3,8 @@
 #include "layouts.hpp"
 #include "workset.hpp"
 #include "phx_utils.hpp"
+#include "kernel_sizes.hpp"
+#include "parallel_elems.hpp"
 
 #include <Intrepid2_MiniTensor.h>
 
@@ -17,6 +19,7 @@ PHX_EVALUATOR_CTOR(FirstPK, p) :
   cauchy        (p.get<std::string>("Cauchy Name"), dl->qp_tensor),
   first_pk      (p.get<std::string>("First PK Name"), dl->qp_tensor)
 {
+  num_nodes = dl->node_qp_vector->dimension(1);
   num_qps = dl->node_qp_vector->dimension(2);
   num_dims = dl->node_qp_vector->dimension(3);
 
@@ -44,54 +47,63 @@ PHX_POST_REGISTRATION_SETUP(FirstPK, data, fm)
   this->utils.setFieldData(first_pk, fm);
 }
 
-PHX_EVALUATE_FIELDS(FirstPK, workset)
+template <typename EvalT, typename Traits>
+template <unsigned N, unsigned Q, unsigned D>
+void FirstPK<EvalT, Traits>::compute(unsigned ws_size)
 {
-  /* populate first pk tensor with cauchy tensor */
-  for (unsigned elem=0; elem < workset.size; ++elem)
-  for (unsigned qp=0; qp < num_qps; ++qp)
-  for (unsigned i=0; i < num_dims; ++i)
-  for (unsigned j=0; j < num_dims; ++j)
-    first_pk(elem,qp,i,j) = cauchy(elem,qp,i,j);
-
-  /* add in pressure if this is a mixed formulation */
-  if (have_pressure) {
-    for (unsigned elem=0; elem < workset.size; ++elem) {
-      for (unsigned qp=0; qp < num_qps; ++qp) {
+  unsigned const nq = kernel_size<Q>(num_qps);
+  unsigned const nd = kernel_size<D>(num_dims);
+
+  parallel_elems(ws_size, [=] (int elem) {
+
+    /* populate first pk tensor with cauchy tensor */
+    for (unsigned qp=0; qp < nq; ++qp)
+    for (unsigned i=0; i < nd; ++i)
+    for (unsigned j=0; j < nd; ++j)
+      first_pk(elem,qp,i,j) = cauchy(elem,qp,i,j);
+
+    /* add in pressure if this is a mixed formulation */
+    if (have_pressure) {
+      for (unsigned qp=0; qp < nq; ++qp) {
         ScalarT p = first_pk(elem, qp, 0, 0);
-        for (unsigned i=1; i < num_dims; ++i)
+        for (unsigned i=1; i < nd; ++i)
           p += first_pk(elem, qp, i, i);
-        p /= num_dims;
-        for (unsigned i=0; i < num_dims; ++i)
+        p /= nd;
+        for (unsigned i=0; i < nd; ++i)
           first_pk(elem,qp,i,i) += pressure(elem,qp) - p;
       }
     }
-  }
 
-  /* pull back to the reference config if this is large strain */
-  if (! small_strain) {
-    ScalarT J;
-    Intrepid2::Tensor<ScalarT> F(num_dims);
-    Intrepid2::Tensor<ScalarT> Finv(num_dims);
-    Intrepid2::Tensor<ScalarT> sigma(num_dims);
-    Intrepid2::Tensor<ScalarT> P(num_dims);
-    Intrepid2::Tensor<ScalarT> I(Intrepid2::eye<ScalarT>(num_dims));
-    for (unsigned elem=0; elem < workset.size; ++elem) {
-      for (unsigned qp=0; qp < num_qps; ++qp) {
+    /* pull back to the reference config if this is large strain */
+    if (! small_strain) {
+      ScalarT J;
+      Intrepid2::Tensor<ScalarT, D> F(nd);
+      Intrepid2::Tensor<ScalarT, D> Finv(nd);
+      Intrepid2::Tensor<ScalarT, D> sigma(nd);
+      Intrepid2::Tensor<ScalarT, D> P(nd);
+      for (unsigned qp=0; qp < nq; ++qp) {
         J = det_def_grad(elem,qp);
-        for (unsigned i=0; i < num_dims; ++i) {
-          for (unsigned j=0; j < num_dims; ++j) {
+        for (unsigned i=0; i < nd; ++i) {
+          for (unsigned j=0; j < nd; ++j) {
             F(i,j) = def_grad(elem,qp,i,j);
             sigma(i,j) = cauchy(elem,qp,i,j);
           }
         }
         Finv = Intrepid2::inverse(F);
         P = J*sigma*Intrepid2::transpose(Finv);
-        for (unsigned i=0; i < num_dims; ++i)
-        for (unsigned j=0; j < num_dims; ++j)
+        for (unsigned i=0; i < nd; ++i)
+        for (unsigned j=0; j < nd; ++j)
           first_pk(elem,qp,i,j) = P(i,j);
       }
     }
-  }
+
+  });
+}
+
+PHX_EVALUATE_FIELDS(FirstPK, workset)
+{
+  GOAL_DISPATCH_KERNEL(num_nodes, num_qps, num_dims,
+      this->template compute, workset.size);
 }
 
 GOAL_INSTANTIATE_ALL(FirstPK)
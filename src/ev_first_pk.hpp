@@ -16,6 +16,7 @@ PHX_EVALUATOR_CLASS(FirstPK)
 
     RCP<Layouts> dl;
 
+    unsigned num_nodes;
     unsigned num_qps;
     unsigned num_dims;
 
@@ -29,6 +30,9 @@ PHX_EVALUATOR_CLASS(FirstPK)
 
     PHX::MDField<ScalarT, Elem, QP, Dim, Dim> first_pk;
 
+    template <unsigned N, unsigned Q, unsigned D>
+    void compute(unsigned ws_size);
+
 PHX_EVALUATOR_CLASS_END
 
 }
@@ -52,15 +52,25 @@ PHX_POST_REGISTRATION_SETUP(GatherDual, data, fm)
 PHX_EVALUATE_FIELDS(GatherDual, workset)
 {
   CHECK(workset.z != Teuchos::null);
-  ArrayRCP<const ST> dual = workset.z->get1dView();
-  CHECK(dual != Teuchos::null);
+  /* the error is localized in the sum of the qois, whose dual is the
+     sum of the duals of each qoi */
+  unsigned num_qois = workset.z->getNumVectors();
 
-  for (unsigned elem=0; elem < workset.size; ++elem) {
-    apf::MeshEntity* e = workset.ents[elem];
-    for (unsigned node=0; node < num_nodes; ++node) {
-      for (unsigned eq=0; eq < num_eqs; ++eq) {
-        LO lid = mesh->get_lid(e, node, eq);
-        nodal[eq](elem, node) = dual[lid];
+  for (unsigned elem=0; elem < workset.size; ++elem)
+  for (unsigned node=0; node < num_nodes; ++node)
+  for (unsigned eq=0; eq < num_eqs; ++eq)
+    nodal[eq](elem, node) = 0.0;
+
+  for (unsigned i=0; i < num_qois; ++i) {
+    ArrayRCP<const ST> dual = workset.z->getData(i);
+    CHECK(dual != Teuchos::null);
+    for (unsigned elem=0; elem < workset.size; ++elem) {
+      apf::MeshEntity* e = workset.ents[elem];
+      for (unsigned node=0; node < num_nodes; ++node) {
+        for (unsigned eq=0; eq < num_eqs; ++eq) {
+          LO lid = mesh->get_lid(e, node, eq);
+          nodal[eq](elem, node) += dual[lid];
+        }
       }
     }
   }
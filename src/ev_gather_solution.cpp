@@ -4,6 +4,7 @@
 #include "layouts.hpp"
 #include "phx_utils.hpp"
 #include "control.hpp"
+#include "parallel_elems.hpp"
 
 namespace goal {
 
@@ -52,19 +53,20 @@ evaluateFields(typename Traits::EvalData workset)
   ArrayRCP<const ST> sol = v->get1dView();
   CHECK(sol != Teuchos::null);
 
-  for (unsigned elem=0; elem < workset.size; ++elem) {
-    apf::MeshEntity* e = workset.ents[elem];
+  ST const* s = sol.getRawPtr();
+  LO const* lids = mesh->get_elem_lids(workset.set, workset.ws_idx).data();
+  parallel_elems(workset.size, [=] (int elem) {
     for (unsigned node=0; node < num_nodes; ++node) {
       for (unsigned eq=0; eq < num_eqs; ++eq) {
-        LO lid = mesh->get_lid(e, node, eq);
-        u[eq](elem, node) = sol[lid];
+        LO lid = lids[(elem*num_nodes + node)*num_eqs + eq];
+        u[eq](elem, node) = s[lid];
       }
     }
-  }
+  });
 }
 
-template <typename Traits>
-GatherSolution<GoalTraits::Derivative, Traits>::
+template <int N, typename Traits>
+GatherSolution<GoalTraits::DerivativeN<N>, Traits>::
 GatherSolution(ParameterList const& p) :
   dl      (p.get<RCP<Layouts> >("Layouts")),
   mesh    (p.get<RCP<Mesh> >("Mesh")),
@@ -83,8 +85,8 @@ GatherSolution(ParameterList const& p) :
   this->setName("Gather " + sol_names[index]);
 }
 
-template <typename Traits>
-void GatherSolution<GoalTraits::Derivative, Traits>::
+template <int N, typename Traits>
+void GatherSolution<GoalTraits::DerivativeN<N>, Traits>::
 postRegistrationSetup(
     typename Traits::SetupData d,
     PHX::FieldManager<Traits>& fm)
@@ -93,8 +95,8 @@ postRegistrationSetup(
     this->utils.setFieldData(u[i], fm);
 }
 
-template <typename Traits>
-void GatherSolution<GoalTraits::Derivative, Traits>::
+template <int N, typename Traits>
+void GatherSolution<GoalTraits::DerivativeN<N>, Traits>::
 evaluateFields(typename Traits::EvalData workset)
 {
   CHECK(workset.u != Teuchos::null);
@@ -108,17 +110,18 @@ evaluateFields(typename Traits::EvalData workset)
   else if (index == 1) fad_init = workset.beta;
   else if (index == 2) fad_init = workset.alpha;
 
-  for (unsigned elem=0; elem < workset.size; ++elem) {
-    apf::MeshEntity* e = workset.ents[elem];
+  ST const* s = sol.getRawPtr();
+  LO const* lids = mesh->get_elem_lids(workset.set, workset.ws_idx).data();
+  parallel_elems(workset.size, [=] (int elem) {
     for (unsigned node=0; node < num_nodes; ++node) {
       for (unsigned eq=0; eq < num_eqs; ++eq) {
-        LO lid = mesh->get_lid(e, node, eq);
         unsigned offset = node*num_eqs + eq;
-        u[eq](elem, node).val() = sol[lid];
+        LO lid = lids[elem*num_nodes*num_eqs + offset];
+        u[eq](elem, node).val() = s[lid];
         u[eq](elem, node).fastAccessDx(offset) = fad_init;
       }
     }
-  }
+  });
 }
 
 GOAL_INSTANTIATE_ALL(GatherSolution)
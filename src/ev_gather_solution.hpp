@@ -49,10 +49,10 @@ class GatherSolution<GoalTraits::Forward, Traits> :
 
 /* jacobian specialization */
 
-template <typename Traits>
-class GatherSolution<GoalTraits::Derivative, Traits> :
+template <int N, typename Traits>
+class GatherSolution<GoalTraits::DerivativeN<N>, Traits> :
   public PHX::EvaluatorWithBaseImpl<Traits>,
-  public PHX::EvaluatorDerived<GoalTraits::Derivative, Traits>
+  public PHX::EvaluatorDerived<GoalTraits::DerivativeN<N>, Traits>
 {
   public:
 
@@ -66,7 +66,7 @@ class GatherSolution<GoalTraits::Derivative, Traits> :
 
   private:
 
-    typedef typename GoalTraits::Derivative::ScalarT ScalarT;
+    typedef typename GoalTraits::DerivativeN<N>::ScalarT ScalarT;
 
     RCP<Layouts> dl;
     RCP<Mesh> mesh;
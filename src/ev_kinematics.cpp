@@ -3,6 +3,8 @@
 #include "layouts.hpp"
 #include "workset.hpp"
 #include "phx_utils.hpp"
+#include "kernel_sizes.hpp"
+#include "parallel_elems.hpp"
 #include <Intrepid2_MiniTensor.h>
 
 namespace goal {
@@ -13,6 +15,7 @@ PHX_EVALUATOR_CTOR(Kinematics, p) :
   def_grad      (p.get<std::string>("Def Grad Name"), dl->qp_tensor),
   det_def_grad  (p.get<std::string>("Det Def Grad Name"), dl->qp_scalar)
 {
+  num_nodes = dl->node_qp_vector->dimension(1);
   num_qps = dl->node_qp_vector->dimension(2);
   num_dims = dl->node_qp_vector->dimension(3);
 
@@ -35,22 +38,32 @@ PHX_POST_REGISTRATION_SETUP(Kinematics, data, fm)
   this->utils.setFieldData(det_def_grad, fm);
 }
 
-PHX_EVALUATE_FIELDS(Kinematics, workset)
+template <typename EvalT, typename Traits>
+template <unsigned N, unsigned Q, unsigned D>
+void Kinematics<EvalT, Traits>::compute(unsigned ws_size)
 {
-  Intrepid2::Tensor<ScalarT> F(num_dims);
-  for (unsigned elem=0; elem < workset.size; ++elem) {
-    for (unsigned qp=0; qp < num_qps; ++qp) {
-      for (unsigned i=0; i < num_dims; ++i)
-      for (unsigned j=0; j < num_dims; ++j)
+  unsigned const nq = kernel_size<Q>(num_qps);
+  unsigned const nd = kernel_size<D>(num_dims);
+  parallel_elems(ws_size, [=] (int elem) {
+    Intrepid2::Tensor<ScalarT, D> F(nd);
+    for (unsigned qp=0; qp < nq; ++qp) {
+      for (unsigned i=0; i < nd; ++i)
+      for (unsigned j=0; j < nd; ++j)
         def_grad(elem,qp,i,j) = grad_u[i](elem,qp,j);
-      for (unsigned i=0; i < num_dims; ++i)
+      for (unsigned i=0; i < nd; ++i)
         def_grad(elem,qp,i,i) += 1.0;
-      for (unsigned i=0; i < num_dims; ++i)
-      for (unsigned j=0; j < num_dims; ++j)
+      for (unsigned i=0; i < nd; ++i)
+      for (unsigned j=0; j < nd; ++j)
         F(i,j) = def_grad(elem,qp,i,j);
       det_def_grad(elem,qp) = Intrepid2::det(F);
     }
-  }
+  });
+}
+
+PHX_EVALUATE_FIELDS(Kinematics, workset)
+{
+  GOAL_DISPATCH_KERNEL(num_nodes, num_qps, num_dims,
+      this->template compute, workset.size);
 }
 
 GOAL_INSTANTIATE_ALL(Kinematics)
@@ -17,6 +17,7 @@ PHX_EVALUATOR_CLASS(Kinematics)
     RCP<Layouts> dl;
     Teuchos::Array<std::string> disp_names;
 
+    unsigned num_nodes;
     unsigned num_qps;
     unsigned num_dims;
 
@@ -25,6 +26,9 @@ PHX_EVALUATOR_CLASS(Kinematics)
     PHX::MDField<ScalarT, Elem, QP, Dim, Dim> def_grad;
     PHX::MDField<ScalarT, Elem, QP> det_def_grad;
 
+    template <unsigned N, unsigned Q, unsigned D>
+    void compute(unsigned ws_size);
+
 PHX_EVALUATOR_CLASS_END
 
 }
@@ -0,0 +1,151 @@
+#include "ev_mechanics_fused.hpp"
+#include "traits.hpp"
+#include "layouts.hpp"
+#include "workset.hpp"
+#include "state_fields.hpp"
+#include "phx_utils.hpp"
+#include "expression.hpp"
+#include "assert_param.hpp"
+#include "kernel_sizes.hpp"
+
+namespace goal {
+
+static RCP<ParameterList> get_valid_params()
+{
+  RCP<ParameterList> p = rcp(new ParameterList);
+  p->set<double>("E", 0.0);
+  p->set<double>("nu", 0.0);
+  p->set<double>("alpha", 0.0);
+  p->set<double>("rho", 0.0);
+  p->set<bool>("analytic tangent", false);
+  return p;
+}
+
+static void validate_params(
+    RCP<const ParameterList> p,
+    RCP<const ParameterList> tp)
+{
+  assert_param(p, "E");
+  assert_param(p, "nu");
+  if (tp != Teuchos::null)
+    assert_param(p, "alpha");
+  p->validateParameters(*get_valid_params(), 0);
+}
+
+PHX_EVALUATOR_CTOR(MechanicsFused, p) :
+  dl          (p.get<RCP<Layouts> >("Layouts")),
+  states      (p.get<RCP<StateFields> >("State Fields")),
+  params      (p.get<RCP<const ParameterList> >("Material Params")),
+  temp_params (p.get<RCP<const ParameterList> >("Temperature Params")),
+  disp_names  (p.get<Teuchos::Array<std::string> >("Disp Names")),
+  wDv         (p.get<std::string>("Weighted Dv Name"), dl->qp_scalar)
+{
+  validate_params(params, temp_params);
+  E = params->get<double>("E");
+  nu = params->get<double>("nu");
+
+  have_temp = (Teuchos::nonnull(temp_params));
+  if (have_temp) alpha = params->get<double>("alpha");
+
+  num_nodes = dl->node_qp_vector->dimension(1);
+  num_qps = dl->node_qp_vector->dimension(2);
+  num_dims = dl->node_qp_vector->dimension(3);
+
+  get_grad_field(p.get<std::string>("BF Name"), dl, gBF);
+  this->addDependentField(gBF);
+  this->addDependentField(wDv);
+
+  u.resize(num_dims);
+  resid.resize(num_dims);
+  for (unsigned i=0; i < num_dims; ++i) {
+    get_field(disp_names[i], dl, u[i]);
+    get_resid_field(disp_names[i], dl, resid[i]);
+    this->addDependentField(u[i]);
+    this->addEvaluatedField(resid[i]);
+  }
+
+  this->setName("Mechanics Fused");
+}
+
+PHX_POST_REGISTRATION_SETUP(MechanicsFused, data, fm)
+{
+  this->utils.setFieldData(gBF, fm);
+  this->utils.setFieldData(wDv, fm);
+  for (unsigned i=0; i < num_dims; ++i) {
+    this->utils.setFieldData(u[i], fm);
+    this->utils.setFieldData(resid[i], fm);
+  }
+}
+
+/* one pass per element: grad u, the stress and its weak form at each
+   qp, accumulated straight into the element residual. only the
+   residual fields and the cauchy state leave the element. */
+template <typename EvalT, typename Traits>
+template <unsigned N, unsigned Q, unsigned D>
+void MechanicsFused<EvalT, Traits>::compute(
+    typename Traits::EvalData workset, double thermal)
+{
+  unsigned const nn = kernel_size<N>(num_nodes);
+  unsigned const nq = kernel_size<Q>(num_qps);
+  unsigned const nd = kernel_size<D>(num_dims);
+  double lambda = E*nu/((1.0+nu)*(1.0-2.0*nu));
+  double mu = E/(2.0*(1.0+nu));
+  ScalarT G[3][3];
+  ScalarT sigma[3][3];
+  ScalarT tr;
+  Intrepid2::Tensor<ScalarT> state(num_dims);
+  for (unsigned elem=0; elem < workset.size; ++elem) {
+    apf::MeshEntity* e = workset.ents[elem];
+    for (unsigned node=0; node < nn; ++node)
+    for (unsigned i=0; i < nd; ++i)
+      resid[i](elem, node) = ScalarT(0.0);
+    for (unsigned qp=0; qp < nq; ++qp) {
+      for (unsigned i=0; i < nd; ++i)
+      for (unsigned j=0; j < nd; ++j)
+        G[i][j] = ScalarT(0.0);
+      for (unsigned node=0; node < nn; ++node)
+      for (unsigned i=0; i < nd; ++i)
+      for (unsigned j=0; j < nd; ++j)
+        G[i][j] += u[i](elem, node)*gBF(elem, node, qp, j);
+      tr = ScalarT(0.0);
+      for (unsigned i=0; i < nd; ++i)
+        tr += G[i][i];
+      for (unsigned i=0; i < nd; ++i)
+      for (unsigned j=0; j < nd; ++j)
+        sigma[i][j] = mu*(G[i][j] + G[j][i]);
+      for (unsigned i=0; i < nd; ++i)
+        sigma[i][i] += lambda*tr;
+      for (unsigned i=0; i < nd; ++i)
+      for (unsigned j=0; j < nd; ++j)
+        state(i, j) = sigma[i][j];
+      states->set_tensor("cauchy", e, qp, state);
+      for (unsigned i=0; i < nd; ++i)
+        sigma[i][i] -= thermal;
+      double w = wDv(elem, qp);
+      for (unsigned node=0; node < nn; ++node)
+      for (unsigned i=0; i < nd; ++i)
+      for (unsigned j=0; j < nd; ++j)
+        resid[i](elem, node) += sigma[i][j]*gBF(elem, node, qp, j)*w;
+    }
+  }
+}
+
+PHX_EVALUATE_FIELDS(MechanicsFused, workset)
+{
+  /* the thermal stress is uniform over the workset */
+  double thermal = 0.0;
+  if (have_temp) {
+    double three_kappa = E/(1.0-2.0*nu);
+    std::string val = temp_params->get<std::string>("value");
+    double T = expression_eval(val,0,0,0,workset.t_new);
+    double T_ref = temp_params->get<double>("reference");
+    thermal = three_kappa*alpha*(T-T_ref);
+  }
+
+  GOAL_DISPATCH_KERNEL(num_nodes, num_qps, num_dims,
+      this->template compute, workset, thermal);
+}
+
+GOAL_INSTANTIATE_ALL(MechanicsFused)
+
+}
@@ -0,0 +1,51 @@
+#ifndef goal_ev_mechanics_fused_hpp
+#define goal_ev_mechanics_fused_hpp
+
+#include "phx_macros.hpp"
+
+namespace goal {
+
+using Teuchos::RCP;
+using Teuchos::ParameterList;
+
+struct Layouts;
+class StateFields;
+
+/* the small strain elastic residual computed element by element,
+   from the gathered nodal displacements to the element residual,
+   with the displacement gradient and stress kept on the stack. it
+   stands in for kinematics, model elastic, first pk and mechanics
+   residual. */
+PHX_EVALUATOR_CLASS(MechanicsFused)
+
+  private:
+
+    RCP<Layouts> dl;
+    RCP<StateFields> states;
+    RCP<const ParameterList> params;
+    RCP<const ParameterList> temp_params;
+    Teuchos::Array<std::string> disp_names;
+
+    bool have_temp;
+
+    double E; /* elastic modulus */
+    double nu; /* poisson's ratio */
+    double alpha; /* thermal expansion coefficient */
+
+    unsigned num_nodes;
+    unsigned num_qps;
+    unsigned num_dims;
+
+    PHX::MDField<double, Elem, QP> wDv;
+    PHX::MDField<double, Elem, Node, QP, Dim> gBF;
+    std::vector<PHX::MDField<ScalarT, Elem, Node> > u;
+    std::vector<PHX::MDField<ScalarT, Elem, Node> > resid;
+
+    template <unsigned N, unsigned Q, unsigned D>
+    void compute(typename Traits::EvalData workset, double thermal);
+
+PHX_EVALUATOR_CLASS_END
+
+}
+
+#endif
@@ -5,6 +5,9 @@
 #include "mesh.hpp"
 #include "expression.hpp"
 #include "phx_utils.hpp"
+#include "kernel_sizes.hpp"
+#include "local_ad.hpp"
+#include "parallel_elems.hpp"
 
 #include <apf.h>
 #include <apfMesh2.h>
@@ -53,8 +56,22 @@ PHX_EVALUATOR_CTOR(MechanicsResidual, p) :
   get_grad_field(bf_name, dl, gBF);
   this->addDependentField(gBF);
 
+  /* with an analytic tangent the derivative sweeps integrate the real
+     first pk stress and contract its tangent into the element
+     jacobian */
+  tangent_mode = p.isParameter("First PK Tangent Name");
+
   this->addDependentField(wDv);
-  this->addDependentField(stress);
+  if (tangent_mode) {
+    pk = PHX::MDField<double, Elem, QP, Dim, Dim>(
+        p.get<std::string>("First PK Name"), dl->qp_tensor);
+    pk_tangent = PHX::MDField<double, Elem, QP, Dim, Dim, Dim, Dim>(
+        p.get<std::string>("First PK Tangent Name"), dl->qp_tensor4);
+    this->addDependentField(pk);
+    this->addDependentField(pk_tangent);
+  }
+  else
+    this->addDependentField(stress);
   this->setName("Mechanics Residual");
 }
 
@@ -62,7 +79,12 @@ PHX_POST_REGISTRATION_SETUP(MechanicsResidual, data, fm)
 {
   this->utils.setFieldData(wDv, fm);
   this->utils.setFieldData(gBF, fm);
-  this->utils.setFieldData(stress, fm);
+  if (tangent_mode) {
+    this->utils.setFieldData(pk, fm);
+    this->utils.setFieldData(pk_tangent, fm);
+  }
+  else
+    this->utils.setFieldData(stress, fm);
   if (enable_dynamics) {
     for (unsigned i=0; i < num_dims; ++i)
       this->utils.setFieldData(acc[i], fm);
@@ -73,48 +95,106 @@ PHX_POST_REGISTRATION_SETUP(MechanicsResidual, data, fm)
     this->utils.setFieldData(resid[i], fm);
 }
 
-PHX_EVALUATE_FIELDS(MechanicsResidual, workset)
+template <typename EvalT, typename Traits>
+template <unsigned N, unsigned Q, unsigned D>
+void MechanicsResidual<EvalT, Traits>::integrate_stress(unsigned ws_size)
 {
-  for (unsigned elem=0; elem < workset.size; ++elem) {
-    for (unsigned node=0; node < num_nodes; ++node)
-    for (unsigned dim=0; dim < num_dims; ++dim)
+  unsigned const nn = kernel_size<N>(num_nodes);
+  unsigned const nq = kernel_size<Q>(num_qps);
+  unsigned const nd = kernel_size<D>(num_dims);
+  parallel_elems(ws_size, [=] (int elem) {
+    for (unsigned node=0; node < nn; ++node)
+    for (unsigned dim=0; dim < nd; ++dim)
       resid[dim](elem, node) = ScalarT(0.0);
-    for (unsigned qp=0; qp < num_qps; ++qp)
-    for (unsigned node=0; node < num_nodes; ++node)
-    for (unsigned i=0; i < num_dims; ++i)
-    for (unsigned j=0; j < num_dims; ++j)
+    for (unsigned qp=0; qp < nq; ++qp)
+    for (unsigned node=0; node < nn; ++node)
+    for (unsigned i=0; i < nd; ++i)
+    for (unsigned j=0; j < nd; ++j)
       resid[i](elem, node) +=
         stress(elem,qp,i,j)*gBF(elem,node,qp,j)*wDv(elem,qp);
-  }
+  });
+}
+
+/* the element residual with the derivatives
+   dR_ai/du_bk = gamma sum_qp A_ijkl gBF_bl gBF_aj wDv
+   set directly from the tangent A = dP/dF, since dF_kl/du_bk = gBF_bl.
+   the dofs are ordered node-major as in the gather. */
+template <typename EvalT, typename Traits>
+void MechanicsResidual<EvalT, Traits>::integrate_tangent(
+    typename Traits::EvalData workset)
+{
+  unsigned num_dofs = num_nodes*num_dims;
+  double gamma = workset.gamma;
+  parallel_elems(workset.size, [=] (int elem) {
+    for (unsigned a=0; a < num_nodes; ++a) {
+      for (unsigned i=0; i < num_dims; ++i) {
+        double r = 0.0;
+        for (unsigned qp=0; qp < num_qps; ++qp)
+        for (unsigned j=0; j < num_dims; ++j)
+          r += pk(elem,qp,i,j)*gBF(elem,a,qp,j)*wDv(elem,qp);
+        ScalarT v = residual_value<ScalarT>(num_dofs, r);
+        for (unsigned b=0; b < num_nodes; ++b) {
+          for (unsigned k=0; k < num_dims; ++k) {
+            double d = 0.0;
+            for (unsigned qp=0; qp < num_qps; ++qp)
+            for (unsigned j=0; j < num_dims; ++j)
+            for (unsigned l=0; l < num_dims; ++l)
+              d += pk_tangent(elem,qp,i,j,k,l)*
+                gBF(elem,b,qp,l)*gBF(elem,a,qp,j)*wDv(elem,qp);
+            set_derivative(v, b*num_dims + k, gamma*d);
+          }
+        }
+        resid[i](elem, a) = v;
+      }
+    }
+  });
+}
+
+PHX_EVALUATE_FIELDS(MechanicsResidual, workset)
+{
+  if (tangent_mode)
+    integrate_tangent(workset);
+  else
+    GOAL_DISPATCH_KERNEL(num_nodes, num_qps, num_dims,
+        this->template integrate_stress, workset.size);
 
   if (enable_dynamics) {
-    for (unsigned elem=0; elem < workset.size; ++elem)
-    for (unsigned node=0; node < num_nodes; ++node)
-    for (unsigned qp=0; qp < num_qps; ++qp)
-    for (unsigned i=0; i < num_dims; ++i)
-      resid[i](elem, node) +=
-        rho * acc[i](elem, qp)*BF(elem,node,qp)*wDv(elem,qp);
+    parallel_elems(workset.size, [=] (int elem) {
+      for (unsigned node=0; node < num_nodes; ++node)
+      for (unsigned qp=0; qp < num_qps; ++qp)
+      for (unsigned i=0; i < num_dims; ++i)
+        resid[i](elem, node) +=
+          rho * acc[i](elem, qp)*BF(elem,node,qp)*wDv(elem,qp);
+    });
   }
 
+  /* the body force expressions share one global parser, so they are
+     evaluated serially and only the integration is threaded */
   if (have_body_force) {
     apf::Vector3 p(0,0,0);
     apf::Mesh* m = mesh->get_apf_mesh();
     unsigned q_order = mesh->get_q_order();
     double time = workset.t_new;
+    std::vector<double> force(workset.size*num_qps*num_dims);
     for (unsigned elem=0; elem < workset.size; ++elem) {
       apf::MeshEntity* e = workset.ents[elem];
       apf::MeshElement* me = apf::createMeshElement(m, e);
-      for (unsigned node=0; node < num_nodes; ++node) {
-        for (unsigned qp=0; qp < num_qps; ++qp) {
-          apf::getIntPoint(me, q_order, qp, p);
-          for (unsigned i=0; i < num_dims; ++i) {
-            double v = expression_eval(body_force[i],p[0],p[1],p[2],time);
-            resid[i](elem,node) -= rho*v*BF(elem,node,qp)*wDv(elem,qp);
-          }
-        }
+      for (unsigned qp=0; qp < num_qps; ++qp) {
+        apf::getIntPoint(me, q_order, qp, p);
+        for (unsigned i=0; i < num_dims; ++i)
+          force[(elem*num_qps + qp)*num_dims + i] =
+            expression_eval(body_force[i],p[0],p[1],p[2],time);
       }
       apf::destroyMeshElement(me);
     }
+    double const* f = force.data();
+    parallel_elems(workset.size, [=] (int elem) {
+      for (unsigned node=0; node < num_nodes; ++node)
+      for (unsigned qp=0; qp < num_qps; ++qp)
+      for (unsigned i=0; i < num_dims; ++i)
+        resid[i](elem,node) -= rho*f[(elem*num_qps + qp)*num_dims + i]*
+          BF(elem,node,qp)*wDv(elem,qp);
+    });
   }
 
 }
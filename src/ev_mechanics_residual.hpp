@@ -23,6 +23,7 @@ PHX_EVALUATOR_CLASS(MechanicsResidual)
 
     bool enable_dynamics;
     bool have_body_force;
+    bool tangent_mode;
 
     double rho;
     Teuchos::Array<std::string> body_force;
@@ -38,6 +39,15 @@ PHX_EVALUATOR_CLASS(MechanicsResidual)
     std::vector<PHX::MDField<ScalarT, Elem, QP> > acc;
     std::vector<PHX::MDField<ScalarT, Elem, Node> > resid;
 
+    /* the analytic tangent mode of derivative sweeps */
+    PHX::MDField<double, Elem, QP, Dim, Dim> pk;
+    PHX::MDField<double, Elem, QP, Dim, Dim, Dim, Dim> pk_tangent;
+
+    template <unsigned N, unsigned Q, unsigned D>
+    void integrate_stress(unsigned ws_size);
+
+    void integrate_tangent(typename Traits::EvalData workset);
+
 PHX_EVALUATOR_CLASS_END
 
 }
@@ -5,6 +5,7 @@
 #include "state_fields.hpp"
 #include "control.hpp"
 #include "assert_param.hpp"
+#include "local_ad.hpp"
 
 namespace goal {
 
@@ -20,6 +21,7 @@ static RCP<ParameterList> get_valid_params()
   p->set<double>("C2", 0.0);
   p->set<double>("alpha", 0.0);
   p->set<double>("rho", 0.0);
+  p->set<bool>("local ad", false);
   return p;
 }
 
@@ -52,6 +54,10 @@ PHX_EVALUATOR_CTOR(ModelCreep, p) :
   QR = params->get<double>("QR");
   C2 = params->get<double>("C2");
 
+  local_ad = false;
+  if (params->isParameter("local ad"))
+    local_ad = params->get<bool>("local ad");
+
   num_nodes = dl->node_qp_vector->dimension(1);
   num_qps = dl->node_qp_vector->dimension(2);
   num_dims = dl->node_qp_vector->dimension(3);
@@ -69,190 +75,222 @@ PHX_POST_REGISTRATION_SETUP(ModelCreep, data, fm)
   this->utils.setFieldData(stress, fm);
 }
 
-PHX_EVALUATE_FIELDS(ModelCreep, workset)
+template <typename EvalT, typename Traits>
+template <typename T>
+void ModelCreep<EvalT, Traits>::update(
+    apf::MeshEntity* e,
+    unsigned qp,
+    double dt,
+    Intrepid2::Tensor<T> const& F,
+    Intrepid2::Tensor<T>& sigma)
 {
   /* parameters */
-  ScalarT kappa = E/(3.0*(1.0-2.0*nu));
-  ScalarT mu = E/(2.0*(1.0+nu));
-  ScalarT sq23(std::sqrt(2.0/3.0));
+  T kappa = E/(3.0*(1.0-2.0*nu));
+  T mu = E/(2.0*(1.0+nu));
+  T sq23(std::sqrt(2.0/3.0));
 
   /* quantities at previous time */
-  ScalarT eqps;
-  Intrepid2::Tensor<ScalarT> Fp(num_dims);
-  Intrepid2::Tensor<ScalarT> Fpinv(num_dims);
-  Intrepid2::Tensor<ScalarT> Cpinv(num_dims);
+  double eqps;
+  Intrepid2::Tensor<double> Fp_old(num_dims);
+  Intrepid2::Tensor<T> Fp(num_dims);
+  Intrepid2::Tensor<T> Fpinv(num_dims);
+  Intrepid2::Tensor<T> Cpinv(num_dims);
 
   /* quantities at current time */
-  ScalarT J;
-  ScalarT Jm23;
-  ScalarT dgam;
-  ScalarT dgamp;
-  Intrepid2::Tensor<ScalarT> F(num_dims);
-  Intrepid2::Tensor<ScalarT> Fpn(num_dims);
-  Intrepid2::Tensor<ScalarT> N(num_dims);
-  Intrepid2::Tensor<ScalarT> sigma(num_dims);
-  Intrepid2::Tensor<ScalarT> A(num_dims);
-  Intrepid2::Tensor<ScalarT> expA(num_dims);
-  Intrepid2::Tensor<ScalarT> I(Intrepid2::eye<ScalarT>(num_dims));
+  T J;
+  T Jm23;
+  T dgam;
+  T dgamp;
+  Intrepid2::Tensor<T> Fpn(num_dims);
+  Intrepid2::Tensor<T> N(num_dims);
+  Intrepid2::Tensor<T> A(num_dims);
+  Intrepid2::Tensor<T> expA(num_dims);
+  Intrepid2::Tensor<T> I(Intrepid2::eye<T>(num_dims));
 
   /* trial state quantities */
-  ScalarT f;
-  ScalarT a0;
-  ScalarT a1;
-  ScalarT mubar;
-  Intrepid2::Tensor<ScalarT> be(num_dims);
-  Intrepid2::Tensor<ScalarT> s(num_dims);
+  T f;
+  T a0;
+  T a1;
+  T mubar;
+  Intrepid2::Tensor<T> be(num_dims);
+  Intrepid2::Tensor<T> s(num_dims);
+
+  /* compute the temperature adjusted relaxation parameter */
+  B = A2*std::exp(-QR / 303.0);
+
+  /* deformation gradient quantities */
+  J = Intrepid2::det(F);
+  Jm23 = std::pow(J, -2.0/3.0);
+
+  /* get the plastic part of the def grad quantities */
+  states->get_tensor("Fp_old", e, qp, Fp_old);
+  for (unsigned i=0; i < num_dims; ++i)
+  for (unsigned j=0; j < num_dims; ++j)
+    Fp(i,j) = Fp_old(i,j);
+  Fpinv = Intrepid2::inverse(Fp);
+
+  /* compute the trial state */
+  Cpinv = Fpinv*Intrepid2::transpose(Fpinv);
+  be = Jm23*F*Cpinv*Intrepid2::transpose(F);
+  s = mu*Intrepid2::dev(be);
+  mubar = Intrepid2::trace(be)*mu/num_dims;
+
+  /* compute plasticity yield criteria */
+  T smag = Intrepid2::norm<T>(s);
+  states->get_scalar("eqps_old", e, qp, eqps);
+  f = smag - sq23*(Y + K*eqps);
+
+  /* compute creep onset criteria */
+  a0 = Intrepid2::norm(Intrepid2::dev(be));
+  a1 = Intrepid2::trace(be);
+
+  /* below yield strength */
+  if (f <= 0.0) {
+
+    /* creep increment - return mapping algorithm */
+    if (a0 > 1.0e-12) {
+
+      bool converged = false;
+      T res = 0.0;
+      unsigned iter = 0;
+
+      T X = 1.1e-4;
+      T R = X - dt*B*std::pow(mu, C2)*
+        std::pow((a0 - 2.0/3.0*X*a1)*(a0 - 2.0/3.0*X*a1), C2/2.0);
+
+      std::cout << R << std::endl;
+
+      T dRdX = 1.0 - dt*B*std::pow(mu, C2)*(C2/2.0)*
+        std::pow((a0 - 2.0/3.0*X*a1)*(a0 - 2.0/3.0*X*a1), C2/2.0 - 1.0)*
+        (8.0/9.0*X*a1*a1 - 4.0/3.0*a0*a1);
+
+      while (!converged && iter < 30) {
+        iter++;
+        X = X - R/dRdX;
+        R = X - dt*B*std::pow(mu, C2)*
+          std::pow((a0 - 2.0/3.0*X*a1)*(a0 - 2.0/3.0*X*a1), C2/2.0);
+        dRdX = 1.0 - dt*B*std::pow(mu, C2)*(C2/2.0)*
+          std::pow((a0 - 2.0/3.0*X*a1)*(a0 - 2.0/3.0*X*a1), C2/2.0 - 1.0)*
+          (8.0/9.0*X*a1*a1 - 4.0/3.0*a0*a1);
+        res = std::abs(R);
+        if (res < 1.0e-10)
+          converged = true;
+        if (iter == 30)
+          fail("Creep: pure creep increment failed to converge");
+      }
+
+      /* updates */
+      dgam = X;
+      N = (1.0/smag)*s;
+      s -= 2.0*mubar*dgam*N;
+
+      /* exponential map to get Fpnew */
+      A = dgam*N;
+      expA = Intrepid2::exp(A);
+      Fpn = expA*Fp;
+      states->set_tensor("Fp", e, qp, get_values(Fpn));
+      states->set_scalar("eqps", e, qp, eqps);
+    }
+
+    /* purely elastic increment - no creep */
+    else {
+      states->set_scalar("eqps", e, qp, eqps);
+    }
+  }
+
+  /* plastic increment - return mapping algorithm */
+  else {
+
+    bool converged = false;
+    T H = 0.0;
+    T dH = 0.0;
+    T alpha = 0.0;
+    T res = 0.0;
+    unsigned iter = 0;
+
+    dgam = 0.0;
+    dgamp = 0.0;
+
+    T X = 0.0;
+    T R = f;
+    T dRdX = -2.0*mubar*(1.0+H/(2.0*mubar));
+
+    while (! converged) {
+      iter++;
+      X = X - R/dRdX;
+      H = 2.0*mubar*dt*B*
+        std::pow((smag+(2.0/3.0)*K*X-f)*(smag+(2.0/3.0)*K*X-f), C2/2.0);
+      dH = (4.0/3.0)*C2*mubar*dt*B*K*
+        std::pow((smag+(2.0/3.0)*K*X-f)*(smag+(2.0/3.0)*K*X-f), (C2-1.0)/2.0);
+      R = f - 2.0*mubar*(1.0+K/(3.0*mubar))*X - H;
+      dRdX = -2.0*mubar*(1.0+K/(3.0*mubar)) - dH;
+      res = std::abs(R);
+      if ((res < 1.0e-10) || (res/f) < 1.0e-11)
+        converged = true;
+      if (iter == 30)
+        fail("Creep: plastic increment failed to converge");
+    }
+
+    /* updates */
+    dgamp = X;
+    N = s / Intrepid2::norm(s);
+    s -= -2.0*mubar*dgamp*N + f*N - 2.0*mubar*(1.0+K/(3.0*mubar))*dgamp*N;
+    dgam = dgamp + dt*B*std::pow(Intrepid2::norm(s), C2);
+    alpha = eqps + sq23*dgamp;
+    N = s / Intrepid2::norm(s);
+    states->set_scalar("eqps", e, qp, get_value(alpha));
+
+    /* exponential map to get Fpnew */
+    A = dgam*N;
+    expA = Intrepid2::exp(A);
+    Fpn = expA*Fp;
+    states->set_tensor("Fp", e, qp, get_values(Fpn));
+
+  }
+
+  /* compute stress */
+  T p = 0.5*kappa*(J-1.0/J);
+  sigma = I*p + s/J;
+  states->set_tensor("cauchy", e, qp, get_values(sigma));
+}
+
+PHX_EVALUATE_FIELDS(ModelCreep, workset)
+{
+  Intrepid2::Tensor<ScalarT> F(num_dims);
+  Intrepid2::Tensor<ScalarT> sigma(num_dims);
+  Intrepid2::Tensor<LocalFadType> Fl(num_dims);
+  Intrepid2::Tensor<LocalFadType> sigmal(num_dims);
 
   /* time increment quantities */
   double dt = workset.t_new - workset.t_old;
 
+  /* with local ad the return mapping only carries d/dF */
+  bool local = local_ad && Sacado::IsADType<ScalarT>::value;
+
   for (unsigned elem=0; elem < workset.size; ++elem) {
 
     apf::MeshEntity* e = workset.ents[elem];
 
     for (unsigned qp=0; qp < num_qps; ++qp) {
 
-      /* compute the temperature adjusted relaxation parameter */
-      B = A2*std::exp(-QR / 303.0);
-
-      /* deformation gradient quantities */
       for (unsigned i=0; i < num_dims; ++i)
       for (unsigned j=0; j < num_dims; ++j)
-        F(i,j) = def_grad(elem, qp, i ,j);
-      J = det_def_grad(elem, qp);
-      Jm23 = std::pow(J, -2.0/3.0);
-
-      /* get the plastic part of the def grad quantities */
-      states->get_tensor("Fp_old", e, qp, Fp);
-      Fpinv = Intrepid2::inverse(Fp);
-
-      /* compute the trial state */
-      Cpinv = Fpinv*Intrepid2::transpose(Fpinv);
-      be = Jm23*F*Cpinv*Intrepid2::transpose(F);
-      s = mu*Intrepid2::dev(be);
-      mubar = Intrepid2::trace(be)*mu/num_dims;
-
-      /* compute plasticity yield criteria */
-      ScalarT smag = Intrepid2::norm<ScalarT>(s);
-      states->get_scalar("eqps_old", e, qp, eqps);
-      f = smag - sq23*(Y + K*eqps);
-
-      /* compute creep onset criteria */
-      a0 = Intrepid2::norm(Intrepid2::dev(be));
-      a1 = Intrepid2::trace(be);
-
-      /* below yield strength */
-      if (f <= 0.0) {
-
-        /* creep increment - return mapping algorithm */
-        if (a0 > 1.0e-12) {
-
-          bool converged = false;
-          ScalarT res = 0.0;
-          unsigned iter = 0;
-
-          ScalarT X = 1.1e-4;
-          ScalarT R = X - dt*B*std::pow(mu, C2)*
-            std::pow((a0 - 2.0/3.0*X*a1)*(a0 - 2.0/3.0*X*a1), C2/2.0);
-
-          std::cout << R << std::endl;
-
-          ScalarT dRdX = 1.0 - dt*B*std::pow(mu, C2)*(C2/2.0)*
-            std::pow((a0 - 2.0/3.0*X*a1)*(a0 - 2.0/3.0*X*a1), C2/2.0 - 1.0)*
-            (8.0/9.0*X*a1*a1 - 4.0/3.0*a0*a1);
-
-          while (!converged && iter < 30) {
-            iter++;
-            X = X - R/dRdX;
-            R = X - dt*B*std::pow(mu, C2)*
-              std::pow((a0 - 2.0/3.0*X*a1)*(a0 - 2.0/3.0*X*a1), C2/2.0);
-            dRdX = 1.0 - dt*B*std::pow(mu, C2)*(C2/2.0)*
-              std::pow((a0 - 2.0/3.0*X*a1)*(a0 - 2.0/3.0*X*a1), C2/2.0 - 1.0)*
-              (8.0/9.0*X*a1*a1 - 4.0/3.0*a0*a1);
-            res = std::abs(R);
-            if (res < 1.0e-10)
-              converged = true;
-            if (iter == 30)
-              fail("Creep: pure creep increment failed to converge");
-          }
-
-          /* updates */
-          dgam = X;
-          N = (1.0/smag)*s;
-          s -= 2.0*mubar*dgam*N;
-
-          /* exponential map to get Fpnew */
-          A = dgam*N;
-          expA = Intrepid2::exp(A);
-          Fpn = expA*Fp;
-          states->set_tensor("Fp", e, qp, Fpn);
-          states->set_scalar("eqps", e, qp, eqps);
-        }
-
-        /* purely elastic increment - no creep */
-        else {
-          states->set_scalar("eqps", e, qp, eqps);
-        }
+        F(i,j) = def_grad(elem, qp, i, j);
+
+      if (local) {
+        seed_local(F, Fl);
+        update(e, qp, dt, Fl, sigmal);
+        for (unsigned i=0; i < num_dims; ++i)
+        for (unsigned j=0; j < num_dims; ++j)
+          stress(elem, qp, i, j) = chain_local(sigmal(i, j), F);
       }
 
-      /* plastic increment - return mapping algorithm */
       else {
-
-        bool converged = false;
-        ScalarT H = 0.0;
-        ScalarT dH = 0.0;
-        ScalarT alpha = 0.0;
-        ScalarT res = 0.0;
-        unsigned iter = 0;
-
-        dgam = 0.0;
-        dgamp = 0.0;
-
-        ScalarT X = 0.0;
-        ScalarT R = f;
-        ScalarT dRdX = -2.0*mubar*(1.0+H/(2.0*mubar));
-
-        while (! converged) {
-          iter++;
-          X = X - R/dRdX;
-          H = 2.0*mubar*dt*B*
-            std::pow((smag+(2.0/3.0)*K*X-f)*(smag+(2.0/3.0)*K*X-f), C2/2.0);
-          dH = (4.0/3.0)*C2*mubar*dt*B*K*
-            std::pow((smag+(2.0/3.0)*K*X-f)*(smag+(2.0/3.0)*K*X-f), (C2-1.0)/2.0);
-          R = f - 2.0*mubar*(1.0+K/(3.0*mubar))*X - H;
-          dRdX = -2.0*mubar*(1.0+K/(3.0*mubar)) - dH;
-          res = std::abs(R);
-          if ((res < 1.0e-10) || (res/f) < 1.0e-11)
-            converged = true;
-          if (iter == 30)
-            fail("Creep: plastic increment failed to converge");
-        }
-
-        /* updates */
-        dgamp = X;
-        N = s / Intrepid2::norm(s);
-        s -= -2.0*mubar*dgamp*N + f*N - 2.0*mubar*(1.0+K/(3.0*mubar))*dgamp*N;
-        dgam = dgamp + dt*B*std::pow(Intrepid2::norm(s), C2);
-        alpha = eqps + sq23*dgamp;
-        N = s / Intrepid2::norm(s);
-        states->set_scalar("eqps", e, qp, alpha);
-
-        /* exponential map to get Fpnew */
-        A = dgam*N;
-        expA = Intrepid2::exp(A);
-        Fpn = expA*Fp;
-        states->set_tensor("Fp", e, qp, Fpn);
-
+        update(e, qp, dt, F, sigma);
+        for (unsigned i=0; i < num_dims; ++i)
+        for (unsigned j=0; j < num_dims; ++j)
+          stress(elem, qp, i, j) = sigma(i, j);
       }
-
-      /* compute stress */
-      ScalarT p = 0.5*kappa*(J-1.0/J);
-      sigma = I*p + s/J;
-      states->set_tensor("cauchy", e, qp, sigma);
-      for (unsigned i=0; i < num_dims; ++i)
-      for (unsigned j=0; j < num_dims; ++j)
-        stress(elem, qp, i, j) = sigma(i,j);
-
     }
   }
 }
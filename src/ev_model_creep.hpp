@@ -2,6 +2,11 @@
 #define goal_ev_model_creep_hpp
 
 #include "phx_macros.hpp"
+#include <Intrepid2_MiniTensor.h>
+
+namespace apf {
+class MeshEntity;
+}
 
 namespace goal {
 
@@ -28,6 +33,8 @@ PHX_EVALUATOR_CLASS(ModelCreep)
     double QR; /* activation parameter */
     double C2; /* strain rate exponent */
 
+    bool local_ad;
+
     unsigned num_nodes;
     unsigned num_qps;
     unsigned num_dims;
@@ -36,6 +43,14 @@ PHX_EVALUATOR_CLASS(ModelCreep)
     PHX::MDField<ScalarT, Elem, QP> det_def_grad;
     PHX::MDField<ScalarT, Elem, QP, Dim, Dim> stress;
 
+    template <typename T>
+    void update(
+        apf::MeshEntity* e,
+        unsigned qp,
+        double dt,
+        Intrepid2::Tensor<T> const& F,
+        Intrepid2::Tensor<T>& sigma);
+
   PHX_EVALUATOR_CLASS_END
 
 }
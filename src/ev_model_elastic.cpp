@@ -6,6 +6,8 @@
 #include "phx_utils.hpp"
 #include "expression.hpp"
 #include "assert_param.hpp"
+#include "local_ad.hpp"
+#include "parallel_elems.hpp"
 
 namespace goal {
 
@@ -16,6 +18,7 @@ static RCP<ParameterList> get_valid_params()
   p->set<double>("nu", 0.0);
   p->set<double>("alpha", 0.0);
   p->set<double>("rho", 0.0);
+  p->set<bool>("analytic tangent", false);
   return p;
 }
 
@@ -49,49 +52,128 @@ PHX_EVALUATOR_CTOR(ModelElastic, p) :
   num_qps = dl->node_qp_vector->dimension(2);
   num_dims = dl->node_qp_vector->dimension(3);
 
-  grad_u.resize(num_dims);
-  for (unsigned i=0; i < num_dims; ++i) {
-    get_grad_field(disp_names[i], dl, grad_u[i]);
-    this->addDependentField(grad_u[i]);
+  /* with an analytic tangent the derivative sweeps evaluate the real
+     first pk stress and its tangent from the nodal values instead of
+     the cauchy stress */
+  tangent_mode = p.isParameter("First PK Tangent Name");
+
+  if (tangent_mode) {
+    u.resize(num_dims);
+    for (unsigned i=0; i < num_dims; ++i) {
+      get_field(disp_names[i], dl, u[i]);
+      this->addDependentField(u[i]);
+    }
+    get_grad_field(p.get<std::string>("BF Name"), dl, gBF);
+    this->addDependentField(gBF);
+    pk = PHX::MDField<double, Elem, QP, Dim, Dim>(
+        p.get<std::string>("First PK Name"), dl->qp_tensor);
+    pk_tangent = PHX::MDField<double, Elem, QP, Dim, Dim, Dim, Dim>(
+        p.get<std::string>("First PK Tangent Name"), dl->qp_tensor4);
+    this->addEvaluatedField(pk);
+    this->addEvaluatedField(pk_tangent);
+  }
+
+  else {
+    grad_u.resize(num_dims);
+    for (unsigned i=0; i < num_dims; ++i) {
+      get_grad_field(disp_names[i], dl, grad_u[i]);
+      this->addDependentField(grad_u[i]);
+    }
+    this->addEvaluatedField(stress);
   }
 
-  this->addEvaluatedField(stress);
   this->setName("Model Elastic");
 }
 
 PHX_POST_REGISTRATION_SETUP(ModelElastic, data, fm)
 {
-  for (unsigned i=0; i < num_dims; ++i)
-    this->utils.setFieldData(grad_u[i], fm);
-  this->utils.setFieldData(stress, fm);
+  if (tangent_mode) {
+    for (unsigned i=0; i < num_dims; ++i)
+      this->utils.setFieldData(u[i], fm);
+    this->utils.setFieldData(gBF, fm);
+    this->utils.setFieldData(pk, fm);
+    this->utils.setFieldData(pk_tangent, fm);
+  }
+  else {
+    for (unsigned i=0; i < num_dims; ++i)
+      this->utils.setFieldData(grad_u[i], fm);
+    this->utils.setFieldData(stress, fm);
+  }
+}
+
+/* the real stress and the constant isotropic moduli
+   C(i,j,k,l) = dsigma_ij/du_k,l, which is also dP/dF for small
+   strains. the displacement gradient is interpolated from the real
+   nodal values, so no derivatives are carried. */
+template <typename EvalT, typename Traits>
+void ModelElastic<EvalT, Traits>::
+compute_tangent(typename Traits::EvalData workset)
+{
+  double lambda = E*nu/((1.0+nu)*(1.0-2.0*nu));
+  double mu = E/(2.0*(1.0+nu));
+  apf::MeshEntity* const* ents = workset.ents.data();
+  parallel_elems(workset.size, [=] (int elem) {
+    Intrepid2::Tensor<double> G(num_dims);
+    Intrepid2::Tensor<double> eps(num_dims);
+    Intrepid2::Tensor<double> sigma(num_dims);
+    Intrepid2::Tensor<double> I(Intrepid2::eye<double>(num_dims));
+    apf::MeshEntity* e = ents[elem];
+    for (unsigned qp=0; qp < num_qps; ++qp) {
+      G = Intrepid2::zero<double>(num_dims);
+      for (unsigned node=0; node < num_nodes; ++node)
+      for (unsigned i=0; i < num_dims; ++i)
+      for (unsigned j=0; j < num_dims; ++j)
+        G(i,j) += get_value(u[i](elem,node)) * gBF(elem,node,qp,j);
+      eps = 0.5*(G + Intrepid2::transpose(G));
+      sigma = eps*(2.0*mu) + I*(lambda*Intrepid2::trace(eps));
+      states->set_tensor("cauchy",e,qp,sigma);
+      for (unsigned i=0; i < num_dims; ++i)
+      for (unsigned j=0; j < num_dims; ++j) {
+        pk(elem,qp,i,j) = sigma(i,j);
+        for (unsigned k=0; k < num_dims; ++k)
+        for (unsigned l=0; l < num_dims; ++l)
+          pk_tangent(elem,qp,i,j,k,l) = lambda*I(i,j)*I(k,l) +
+            mu*(I(i,k)*I(j,l) + I(i,l)*I(j,k));
+      }
+    }
+  });
 }
 
+/* each element only sets the states of its own points */
 PHX_EVALUATE_FIELDS(ModelElastic, workset)
 {
-  ScalarT lambda = E*nu/((1.0+nu)*(1.0-2.0*nu));
-  ScalarT mu = E/(2.0*(1.0+nu));
+  double lambda = E*nu/((1.0+nu)*(1.0-2.0*nu));
+  double mu = E/(2.0*(1.0+nu));
 
-  Intrepid2::Tensor<ScalarT> eps(num_dims);
-  Intrepid2::Tensor<ScalarT> sigma(num_dims);
-  Intrepid2::Tensor<ScalarT> I(Intrepid2::eye<ScalarT>(num_dims));
+  if (tangent_mode)
+    compute_tangent(workset);
 
-  for (unsigned elem=0; elem < workset.size; ++elem) {
-    for (unsigned qp=0; qp < num_qps; ++qp) {
+  else {
+    apf::MeshEntity* const* ents = workset.ents.data();
+    parallel_elems(workset.size, [=] (int elem) {
 
-      for (unsigned i=0; i < num_dims; ++i)
-      for (unsigned j=0; j < num_dims; ++j)
-        eps(i,j) = 0.5*(grad_u[i](elem,qp,j) + grad_u[j](elem,qp,i));
+      Intrepid2::Tensor<ScalarT> eps(num_dims);
+      Intrepid2::Tensor<ScalarT> sigma(num_dims);
+      Intrepid2::Tensor<ScalarT> I(Intrepid2::eye<ScalarT>(num_dims));
 
-      sigma = eps*(2.0*mu) + I*(lambda*Intrepid2::trace(eps));
+      for (unsigned qp=0; qp < num_qps; ++qp) {
 
-      for (unsigned i=0; i < num_dims; ++i)
-      for (unsigned j=0; j < num_dims; ++j)
-        stress(elem,qp,i,j) = sigma(i,j);
+        apf::MeshEntity* e = ents[elem];
 
-      apf::MeshEntity* e = workset.ents[elem];
-      states->set_tensor("cauchy",e,qp,sigma);
+        for (unsigned i=0; i < num_dims; ++i)
+        for (unsigned j=0; j < num_dims; ++j)
+          eps(i,j) = 0.5*(grad_u[i](elem,qp,j) + grad_u[j](elem,qp,i));
 
-    }
+        sigma = eps*(2.0*mu) + I*(lambda*Intrepid2::trace(eps));
+
+        for (unsigned i=0; i < num_dims; ++i)
+        for (unsigned j=0; j < num_dims; ++j)
+          stress(elem,qp,i,j) = sigma(i,j);
+
+        states->set_tensor("cauchy",e,qp,sigma);
+
+      }
+    });
   }
 
   if (have_temp) {
@@ -103,8 +185,12 @@ PHX_EVALUATE_FIELDS(ModelElastic, workset)
 
     for (unsigned elem=0; elem < workset.size; ++elem)
     for (unsigned qp=0; qp < num_qps; ++qp)
-    for (unsigned i=0; i < num_dims; ++i)
-      stress(elem,qp,i,i) -= three_kappa*alpha*(T-T_ref);
+    for (unsigned i=0; i < num_dims; ++i) {
+      if (tangent_mode)
+        pk(elem,qp,i,i) -= three_kappa*alpha*(T-T_ref);
+      else
+        stress(elem,qp,i,i) -= three_kappa*alpha*(T-T_ref);
+    }
   }
 
 }
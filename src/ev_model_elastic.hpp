@@ -22,6 +22,7 @@ PHX_EVALUATOR_CLASS(ModelElastic)
     Teuchos::Array<std::string> disp_names;
 
     bool have_temp;
+    bool tangent_mode;
 
     double E; /* elastic modulus */
     double nu; /* poisson's ratio */
@@ -34,6 +35,14 @@ PHX_EVALUATOR_CLASS(ModelElastic)
     std::vector<PHX::MDField<ScalarT, Elem, QP, Dim> > grad_u;
     PHX::MDField<ScalarT, Elem, QP, Dim, Dim> stress;
 
+    /* the analytic tangent mode of derivative sweeps */
+    std::vector<PHX::MDField<ScalarT, Elem, Node> > u;
+    PHX::MDField<double, Elem, Node, QP, Dim> gBF;
+    PHX::MDField<double, Elem, QP, Dim, Dim> pk;
+    PHX::MDField<double, Elem, QP, Dim, Dim, Dim, Dim> pk_tangent;
+
+    void compute_tangent(typename Traits::EvalData workset);
+
 PHX_EVALUATOR_CLASS_END
 
 }
@@ -6,6 +6,9 @@
 #include "control.hpp"
 #include "expression.hpp"
 #include "assert_param.hpp"
+#include "phx_utils.hpp"
+#include "local_ad.hpp"
+#include "parallel_elems.hpp"
 
 namespace goal {
 
@@ -18,9 +21,31 @@ static RCP<ParameterList> get_valid_params()
   p->set<double>("Y", 0.0);
   p->set<double>("alpha", 0.0);
   p->set<double>("rho", 0.0);
+  p->set<bool>("local ad", false);
+  p->set<bool>("analytic tangent", false);
   return p;
 }
 
+/* the closed-form tangent differentiates the solution of the return
+   mapping for linear isotropic hardening, H = K eqps. any material
+   parameter outside this set would change the hardening law under it. */
+static void validate_tangent_params(RCP<const ParameterList> p)
+{
+  char const* const linear[] = {
+    "E", "nu", "K", "Y", "alpha", "rho", "local ad", "analytic tangent"};
+  unsigned num_linear = sizeof(linear)/sizeof(linear[0]);
+  ParameterList::ConstIterator it;
+  for (it = p->begin(); it != p->end(); ++it) {
+    std::string const& name = p->name(it);
+    bool found = false;
+    for (unsigned i=0; i < num_linear; ++i)
+      if (name == linear[i]) found = true;
+    if (! found)
+      fail("J2: analytic tangent assumes linear hardening, found: %s",
+          name.c_str());
+  }
+}
+
 static void validate_params(
     RCP<const ParameterList> p,
     RCP<const ParameterList> tp)
@@ -50,6 +75,20 @@ PHX_EVALUATOR_CTOR(ModelJ2, p) :
   K = params->get<double>("K");
   Y = params->get<double>("Y");
 
+  local_ad = false;
+  if (params->isParameter("local ad"))
+    local_ad = params->get<bool>("local ad");
+
+  bool analytic_tangent = false;
+  if (params->isParameter("analytic tangent"))
+    analytic_tangent = params->get<bool>("analytic tangent");
+
+  if (analytic_tangent)
+    validate_tangent_params(params);
+
+  if (local_ad && analytic_tangent)
+    fail("J2: choose one of local ad and analytic tangent");
+
   have_temp = (Teuchos::nonnull(temp_params));
   if (have_temp) alpha = params->get<double>("alpha");
 
@@ -57,130 +96,348 @@ PHX_EVALUATOR_CTOR(ModelJ2, p) :
   num_qps = dl->node_qp_vector->dimension(2);
   num_dims = dl->node_qp_vector->dimension(3);
 
-  this->addDependentField(def_grad);
-  this->addDependentField(det_def_grad);
-  this->addEvaluatedField(stress);
+  /* with an analytic tangent the derivative sweeps evaluate the real
+     first pk stress and its tangent from the nodal values instead of
+     the cauchy stress */
+  tangent_mode = p.isParameter("First PK Tangent Name");
+
+  if (tangent_mode) {
+    Teuchos::Array<std::string> disp_names;
+    disp_names = p.get<Teuchos::Array<std::string> >("Disp Names");
+    u.resize(num_dims);
+    for (unsigned i=0; i < num_dims; ++i) {
+      get_field(disp_names[i], dl, u[i]);
+      this->addDependentField(u[i]);
+    }
+    get_grad_field(p.get<std::string>("BF Name"), dl, gBF);
+    this->addDependentField(gBF);
+    pk = PHX::MDField<double, Elem, QP, Dim, Dim>(
+        p.get<std::string>("First PK Name"), dl->qp_tensor);
+    pk_tangent = PHX::MDField<double, Elem, QP, Dim, Dim, Dim, Dim>(
+        p.get<std::string>("First PK Tangent Name"), dl->qp_tensor4);
+    this->addEvaluatedField(pk);
+    this->addEvaluatedField(pk_tangent);
+  }
+
+  else {
+    this->addDependentField(def_grad);
+    this->addDependentField(det_def_grad);
+    this->addEvaluatedField(stress);
+  }
+
   this->setName("Model J2");
 }
 
 PHX_POST_REGISTRATION_SETUP(ModelJ2, data, fm)
 {
-  this->utils.setFieldData(def_grad, fm);
-  this->utils.setFieldData(det_def_grad, fm);
-  this->utils.setFieldData(stress, fm);
+  if (tangent_mode) {
+    for (unsigned i=0; i < num_dims; ++i)
+      this->utils.setFieldData(u[i], fm);
+    this->utils.setFieldData(gBF, fm);
+    this->utils.setFieldData(pk, fm);
+    this->utils.setFieldData(pk_tangent, fm);
+  }
+  else {
+    this->utils.setFieldData(def_grad, fm);
+    this->utils.setFieldData(det_def_grad, fm);
+    this->utils.setFieldData(stress, fm);
+  }
 }
 
-PHX_EVALUATE_FIELDS(ModelJ2, workset)
+template <typename EvalT, typename Traits>
+template <typename T>
+void ModelJ2<EvalT, Traits>::update(
+    apf::MeshEntity* e,
+    unsigned qp,
+    Intrepid2::Tensor<T> const& F,
+    Intrepid2::Tensor<T>& sigma,
+    Trial* trial)
 {
   /* parameters */
-  ScalarT kappa = E/(3.0*(1.0-2.0*nu));
-  ScalarT mu = E/(2.0*(1.0+nu));
-  ScalarT sq23(std::sqrt(2.0/3.0));
+  T kappa = E/(3.0*(1.0-2.0*nu));
+  T mu = E/(2.0*(1.0+nu));
+  T sq23(std::sqrt(2.0/3.0));
 
   /* quantities at previous time */
-  ScalarT eqps;
-  Intrepid2::Tensor<ScalarT> Fp(num_dims);
-  Intrepid2::Tensor<ScalarT> Fpinv(num_dims);
-  Intrepid2::Tensor<ScalarT> Cpinv(num_dims);
+  double eqps;
+  Intrepid2::Tensor<double> Fp_old(num_dims);
+  Intrepid2::Tensor<T> Fp(num_dims);
+  Intrepid2::Tensor<T> Fpinv(num_dims);
+  Intrepid2::Tensor<T> Cpinv(num_dims);
 
   /* quantities at current time */
-  ScalarT J;
-  ScalarT Jm23;
-  ScalarT dgam;
-  Intrepid2::Tensor<ScalarT> F(num_dims);
-  Intrepid2::Tensor<ScalarT> Fpn(num_dims);
-  Intrepid2::Tensor<ScalarT> N(num_dims);
-  Intrepid2::Tensor<ScalarT> sigma(num_dims);
-  Intrepid2::Tensor<ScalarT> I(Intrepid2::eye<ScalarT>(num_dims));
+  T J;
+  T Jm23;
+  T dgam;
+  Intrepid2::Tensor<T> Fpn(num_dims);
+  Intrepid2::Tensor<T> N(num_dims);
+  Intrepid2::Tensor<T> I(Intrepid2::eye<T>(num_dims));
 
   /* trial state quantities */
-  ScalarT f;
-  ScalarT mubar;
-  Intrepid2::Tensor<ScalarT> be(num_dims);
-  Intrepid2::Tensor<ScalarT> s(num_dims);
+  T f;
+  T mubar;
+  Intrepid2::Tensor<T> be(num_dims);
+  Intrepid2::Tensor<T> s(num_dims);
+
+  /* deformation gradient quantities */
+  J = Intrepid2::det(F);
+  Jm23 = std::pow(J, -2.0/3.0);
+
+  /* get plastic part of def grad quantities */
+  states->get_tensor("Fp_old", e, qp, Fp_old);
+  for (unsigned i=0; i < num_dims; ++i)
+  for (unsigned j=0; j < num_dims; ++j)
+    Fp(i,j) = Fp_old(i,j);
+  Fpinv = Intrepid2::inverse(Fp);
+
+  /* compute the trial state */
+  Cpinv = Fpinv*Intrepid2::transpose(Fpinv);
+  be = Jm23*F*Cpinv*Intrepid2::transpose(F);
+  s = mu*Intrepid2::dev(be);
+  mubar = Intrepid2::trace(be)*mu/num_dims;
+
+  /* check yield condition */
+  T smag = Intrepid2::norm<T>(s);
+  states->get_scalar("eqps_old", e, qp, eqps);
+  f = smag - sq23 * (Y + K*eqps);
+  dgam = 0.0;
+
+  /* plastic increment - return mapping algorithm */
+  if (f > 1.0e-12) {
+
+    bool converged = false;
+    T H = 0.0;
+    T dH = 0.0;
+    T alpha = 0.0;
+    T res = 0.0;
+    unsigned iter = 0;
+
+    T X = 0.0;
+    T R = f;
+    T dRdX = -2.0*mubar*(1.0+H/(3.0*mubar));
+
+    while (!converged && iter < 30) {
+      iter++;
+      X = X - R/dRdX;
+      alpha = eqps + sq23*X;
+      H = K*alpha;
+      dH = K;
+      R = smag - (2.0*mubar*X + sq23*(Y+H));
+      dRdX = -2.0*mubar*(1.0+dH/(3.0*mubar));
+      res = std::abs(R);
+      if ((res < 1.0e-11) || (res/Y < 1.0e-11) || (res/f < 1.0e-11))
+        converged = true;
+      if (iter == 30)
+        fail("J2: return mapping failed to converge");
+    }
+
+    /* updates */
+    dgam = X;
+    N = (1.0/smag)*s;
+    s -= 2.0*mubar*dgam*N;
+    states->set_scalar("eqps", e, qp, get_value(alpha));
+
+    /* get Fpn */
+    Fpn = Intrepid2::exp(dgam*N)*Fp;
+    states->set_tensor("Fp", e, qp, get_values(Fpn));
+  }
 
-  for (unsigned elem=0; elem < workset.size; ++elem) {
+  /* otherwise elastic increment */
+  else
+    states->set_scalar("eqps", e, qp, eqps);
+
+  /* compute stress */
+  T p = 0.5*kappa*(J-1.0/J);
+  sigma = I*p + s/J;
+  states->set_tensor("cauchy", e, qp, get_values(sigma));
+
+  if (! trial) return;
+  trial->plastic = (f > 1.0e-12);
+  trial->J = get_value(J);
+  trial->Jm23 = get_value(Jm23);
+  trial->mubar = get_value(mubar);
+  trial->smag = get_value(smag);
+  trial->f = get_value(f);
+  trial->dgam = get_value(dgam);
+  trial->Cpinv = get_values(Cpinv);
+  trial->FCp = get_values(Intrepid2::Tensor<T>(F*Cpinv));
+  trial->N = Intrepid2::zero<double>(num_dims);
+  if (trial->plastic) trial->N = get_values(N);
+  trial->s = get_values(s);
+}
 
-    apf::MeshEntity* e = workset.ents[elem];
+/* the consistent tangent C(i,j,a,b) = dsigma_ij/dF_ab in closed
+   form, from the trial state and return mapping of the update. with
+   linear hardening the return mapping has the solution
+   dgam = f/(2 mubar + 2K/3), which is differentiated directly. */
+template <typename EvalT, typename Traits>
+void ModelJ2<EvalT, Traits>::tangent(
+    Trial const& trial,
+    Intrepid2::Tensor<double> const& F,
+    Intrepid2::Tensor4<double>& C)
+{
+  double kappa = E/(3.0*(1.0-2.0*nu));
+  double mu = E/(2.0*(1.0+nu));
+  bool plastic = trial.plastic;
+  double J = trial.J;
+  double Jm23 = trial.Jm23;
+  double mubar = trial.mubar;
+  double smag = trial.smag;
+  double f = trial.f;
+  double X = trial.dgam;
+  double c = 2.0*mubar + 2.0*K/3.0;
+  Intrepid2::Tensor<double> const& Cpinv = trial.Cpinv;
+  Intrepid2::Tensor<double> const& FCp = trial.FCp;
+  Intrepid2::Tensor<double> const& N = trial.N;
+  Intrepid2::Tensor<double> const& s = trial.s;
+  Intrepid2::Tensor<double> I(Intrepid2::eye<double>(num_dims));
+  Intrepid2::Tensor<double> Finv = Intrepid2::inverse(F);
+
+  /* directional derivatives along each component of F */
+  Intrepid2::Tensor<double> dF(num_dims);
+  Intrepid2::Tensor<double> dbe(num_dims);
+  Intrepid2::Tensor<double> ds(num_dims);
+  Intrepid2::Tensor<double> dN(num_dims);
+  Intrepid2::Tensor<double> dsigma(num_dims);
+  for (unsigned a=0; a < num_dims; ++a) {
+    for (unsigned b=0; b < num_dims; ++b) {
+      dF = Intrepid2::zero<double>(num_dims);
+      dF(a,b) = 1.0;
+      double trFdF = Intrepid2::trace(Finv*dF);
+      double dJ = J*trFdF;
+      double dJm23 = -2.0/3.0*Jm23*trFdF;
+      dbe = dJm23*FCp*Intrepid2::transpose(F) +
+        Jm23*(dF*Cpinv*Intrepid2::transpose(F) + FCp*Intrepid2::transpose(dF));
+      ds = mu*Intrepid2::dev(dbe);
+      if (plastic) {
+        double dmubar = Intrepid2::trace(dbe)*mu/num_dims;
+        double dsmag = Intrepid2::dotdot(N, ds);
+        double dX = (dsmag*c - 2.0*f*dmubar)/(c*c);
+        dN = (1.0/smag)*(ds - dsmag*N);
+        ds -= 2.0*(dmubar*X + mubar*dX)*N + 2.0*mubar*X*dN;
+      }
+      double dp = 0.5*kappa*(1.0 + 1.0/(J*J))*dJ;
+      dsigma = dp*I + ds/J - (dJ/(J*J))*s;
+      for (unsigned i=0; i < num_dims; ++i)
+      for (unsigned j=0; j < num_dims; ++j)
+        C(i,j,a,b) = dsigma(i,j);
+    }
+  }
+}
+
+/* the real first pk stress P = J sigma F^-T and its tangent
+   A(i,j,k,l) = dP_ij/dF_kl, from the closed-form dsigma/dF and the
+   derivatives of J and F^-1. F is interpolated from the real nodal
+   values, so no derivatives are carried. */
+template <typename EvalT, typename Traits>
+void ModelJ2<EvalT, Traits>::
+compute_tangent(typename Traits::EvalData workset)
+{
+  /* the thermal stress -c (1 + 1/J^2) of the residual sweeps */
+  double c = 0.0;
+  if (have_temp) {
+    double three_kappa = E/(1.0-2.0*nu);
+    std::string val = temp_params->get<std::string>("value");
+    double T = expression_eval(val,0,0,0,workset.t_new);
+    double T_ref = temp_params->get<double>("reference");
+    c = three_kappa*alpha*(T-T_ref);
+  }
+
+  apf::MeshEntity* const* ents = workset.ents.data();
+  parallel_elems(workset.size, [=] (int elem) {
+
+    double J;
+    Intrepid2::Tensor<double> I(Intrepid2::eye<double>(num_dims));
+    Intrepid2::Tensor<double> F(num_dims);
+    Intrepid2::Tensor<double> Finv(num_dims);
+    Intrepid2::Tensor<double> sigma(num_dims);
+    Intrepid2::Tensor<double> P(num_dims);
+    Intrepid2::Tensor4<double> C(num_dims);
+    Trial trial;
+
+    apf::MeshEntity* e = ents[elem];
 
     for (unsigned qp=0; qp < num_qps; ++qp) {
 
-      /* deformation gradient quantities */
+      F = I;
+      for (unsigned node=0; node < num_nodes; ++node)
       for (unsigned i=0; i < num_dims; ++i)
       for (unsigned j=0; j < num_dims; ++j)
-        F(i,j) = def_grad(elem, qp, i, j);
-      J = det_def_grad(elem, qp);
-      Jm23 = std::pow(J, -2.0/3.0);
-
-      /* get plastic part of def grad quantities */
-      states->get_tensor("Fp_old", e, qp, Fp);
-      Fpinv = Intrepid2::inverse(Fp);
-
-      /* compute the trial state */
-      Cpinv = Fpinv*Intrepid2::transpose(Fpinv);
-      be = Jm23*F*Cpinv*Intrepid2::transpose(F);
-      s = mu*Intrepid2::dev(be);
-      mubar = Intrepid2::trace(be)*mu/num_dims;
-
-      /* check yield condition */
-      ScalarT smag = Intrepid2::norm<ScalarT>(s);
-      states->get_scalar("eqps_old", e, qp, eqps);
-      f = smag - sq23 * (Y + K*eqps);
-
-      /* plastic increment - return mapping algorithm */
-      if (f > 1.0e-12) {
-
-        bool converged = false;
-        dgam = 0.0;
-        ScalarT H = 0.0;
-        ScalarT dH = 0.0;
-        ScalarT alpha = 0.0;
-        ScalarT res = 0.0;
-        unsigned iter = 0;
-
-        ScalarT X = 0.0;
-        ScalarT R = f;
-        ScalarT dRdX = -2.0*mubar*(1.0+H/(3.0*mubar));
-
-        while (!converged && iter < 30) {
-          iter++;
-          X = X - R/dRdX;
-          alpha = eqps + sq23*X;
-          H = K*alpha;
-          dH = K;
-          R = smag - (2.0*mubar*X + sq23*(Y+H));
-          dRdX = -2.0*mubar*(1.0+dH/(3.0*mubar));
-          res = std::abs(R);
-          if ((res < 1.0e-11) || (res/Y < 1.0e-11) || (res/f < 1.0e-11))
-            converged = true;
-          if (iter == 30)
-            fail("J2: return mapping failed to converge");
+        F(i,j) += get_value(u[i](elem,node)) * gBF(elem,node,qp,j);
+
+      update(e, qp, F, sigma, &trial);
+      tangent(trial, F, C);
+
+      J = trial.J;
+      Finv = Intrepid2::inverse(F);
+      for (unsigned i=0; i < num_dims; ++i) {
+        sigma(i,i) -= c*(1.0+1.0/(J*J));
+        for (unsigned k=0; k < num_dims; ++k)
+        for (unsigned l=0; l < num_dims; ++l)
+          C(i,i,k,l) += 2.0*c/(J*J)*Finv(l,k);
+      }
+
+      P = J*sigma*Intrepid2::transpose(Finv);
+      for (unsigned i=0; i < num_dims; ++i)
+      for (unsigned j=0; j < num_dims; ++j) {
+        pk(elem,qp,i,j) = P(i,j);
+        for (unsigned k=0; k < num_dims; ++k)
+        for (unsigned l=0; l < num_dims; ++l) {
+          double a = P(i,j)*Finv(l,k) - P(i,l)*Finv(j,k);
+          for (unsigned m=0; m < num_dims; ++m)
+            a += J*C(i,m,k,l)*Finv(j,m);
+          pk_tangent(elem,qp,i,j,k,l) = a;
         }
+      }
+    }
+  });
+}
+
+PHX_EVALUATE_FIELDS(ModelJ2, workset)
+{
+  if (tangent_mode) {
+    compute_tangent(workset);
+    return;
+  }
 
-        /* updates */
-        dgam = X;
-        N = (1.0/smag)*s;
-        s -= 2.0*mubar*dgam*N;
-        states->set_scalar("eqps", e, qp, alpha);
+  ScalarT J;
 
-        /* get Fpn */
-        Fpn = Intrepid2::exp(dgam*N)*Fp;
-        states->set_tensor("Fp", e, qp, Fpn);
-      }
+  /* with local ad the return mapping only carries d/dF */
+  bool local = local_ad && Sacado::IsADType<ScalarT>::value;
 
-      /* otherwise elastic increment */
-      else
-        states->set_scalar("eqps", e, qp, eqps);
+  /* each element only reads and sets the states of its own points */
+  apf::MeshEntity* const* ents = workset.ents.data();
+  parallel_elems(workset.size, [=] (int elem) {
+
+    Intrepid2::Tensor<ScalarT> F(num_dims);
+    Intrepid2::Tensor<ScalarT> sigma(num_dims);
+    Intrepid2::Tensor<LocalFadType> Fl(num_dims);
+    Intrepid2::Tensor<LocalFadType> sigmal(num_dims);
+
+    apf::MeshEntity* e = ents[elem];
+
+    for (unsigned qp=0; qp < num_qps; ++qp) {
 
-      /* compute stress */
-      ScalarT p = 0.5*kappa*(J-1.0/J);
-      sigma = I*p + s/J;
-      states->set_tensor("cauchy", e, qp, sigma);
       for (unsigned i=0; i < num_dims; ++i)
       for (unsigned j=0; j < num_dims; ++j)
-        stress(elem, qp, i, j) = sigma(i, j);
+        F(i,j) = def_grad(elem, qp, i, j);
+
+      if (local) {
+        seed_local(F, Fl);
+        update(e, qp, Fl, sigmal);
+        for (unsigned i=0; i < num_dims; ++i)
+        for (unsigned j=0; j < num_dims; ++j)
+          stress(elem, qp, i, j) = chain_local(sigmal(i, j), F);
+      }
+
+      else {
+        update(e, qp, F, sigma);
+        for (unsigned i=0; i < num_dims; ++i)
+        for (unsigned j=0; j < num_dims; ++j)
+          stress(elem, qp, i, j) = sigma(i, j);
+      }
     }
-  }
+  });
 
   if (have_temp) {
     double three_kappa = E/(1.0-2.0*nu);
@@ -2,6 +2,11 @@
 #define goal_ev_model_j2_hpp
 
 #include "phx_macros.hpp"
+#include <Intrepid2_MiniTensor.h>
+
+namespace apf {
+class MeshEntity;
+}
 
 namespace goal {
 
@@ -21,6 +26,8 @@ PHX_EVALUATOR_CLASS(ModelJ2)
     RCP<const ParameterList> temp_params;
 
     bool have_temp;
+    bool local_ad;
+    bool tangent_mode;
 
     double E; /* elastic modulus */
     double nu; /* poisson's ratio */
@@ -36,6 +43,44 @@ PHX_EVALUATOR_CLASS(ModelJ2)
     PHX::MDField<ScalarT, Elem, QP> det_def_grad;
     PHX::MDField<ScalarT, Elem, QP, Dim, Dim> stress;
 
+    /* the analytic tangent mode of derivative sweeps */
+    std::vector<PHX::MDField<ScalarT, Elem, Node> > u;
+    PHX::MDField<double, Elem, Node, QP, Dim> gBF;
+    PHX::MDField<double, Elem, QP, Dim, Dim> pk;
+    PHX::MDField<double, Elem, QP, Dim, Dim, Dim, Dim> pk_tangent;
+
+    /* the trial state and return mapping of a real update, which
+       the analytic tangent differentiates */
+    struct Trial
+    {
+      bool plastic;
+      double J;
+      double Jm23;
+      double mubar;
+      double smag;
+      double f;
+      double dgam;
+      Intrepid2::Tensor<double> Cpinv;
+      Intrepid2::Tensor<double> FCp;
+      Intrepid2::Tensor<double> N;
+      Intrepid2::Tensor<double> s;
+    };
+
+    template <typename T>
+    void update(
+        apf::MeshEntity* e,
+        unsigned qp,
+        Intrepid2::Tensor<T> const& F,
+        Intrepid2::Tensor<T>& sigma,
+        Trial* trial = 0);
+
+    void tangent(
+        Trial const& trial,
+        Intrepid2::Tensor<double> const& F,
+        Intrepid2::Tensor4<double>& C);
+
+    void compute_tangent(typename Traits::EvalData workset);
+
 PHX_EVALUATOR_CLASS_END
 
 }
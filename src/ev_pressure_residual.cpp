@@ -4,6 +4,8 @@
 #include "mesh.hpp"
 #include "workset.hpp"
 #include "phx_utils.hpp"
+#include "kernel_sizes.hpp"
+#include "parallel_elems.hpp"
 #include "assert_param.hpp"
 
 #include <Intrepid2_MiniTensor.h>
@@ -71,72 +73,84 @@ PHX_POST_REGISTRATION_SETUP(PressureResidual, data, fm)
   this->utils.setFieldData(resid, fm);
 }
 
-PHX_EVALUATE_FIELDS(PressureResidual, workset)
+template <typename EvalT, typename Traits>
+template <unsigned N, unsigned Q, unsigned D>
+void PressureResidual<EvalT, Traits>::compute(unsigned ws_size)
 {
-  Intrepid2::Tensor<ScalarT> sigma(num_dims);
-  Intrepid2::Tensor<ScalarT> F(num_dims);
-  Intrepid2::Tensor<ScalarT> Cinv(num_dims);
+  unsigned const nn = kernel_size<N>(num_nodes);
+  unsigned const nq = kernel_size<Q>(num_qps);
+  unsigned const nd = kernel_size<D>(num_dims);
 
   if (small_strain) {
 
-    for (unsigned elem=0; elem < workset.size; ++elem) {
-      for (unsigned node=0; node < num_nodes; ++node)
+    parallel_elems(ws_size, [=] (int elem) {
+      Intrepid2::Tensor<ScalarT, D> sigma(nd);
+      for (unsigned node=0; node < nn; ++node)
         resid(elem, node) = 0.0;
-      for (unsigned qp=0; qp < num_qps; ++qp) {
-        for (unsigned i=0; i < num_dims; ++i)
-        for (unsigned j=0; j < num_dims; ++j)
+      for (unsigned qp=0; qp < nq; ++qp) {
+        for (unsigned i=0; i < nd; ++i)
+        for (unsigned j=0; j < nd; ++j)
           sigma(i,j) = stress(elem,qp,i,j);
-        ScalarT dUdJ = (1.0/num_dims)*Intrepid2::trace(sigma);
-        for (unsigned node=0; node < num_nodes; ++node)
+        ScalarT dUdJ = (1.0/nd)*Intrepid2::trace(sigma);
+        for (unsigned node=0; node < nn; ++node)
           resid(elem,node) +=
             wDv(elem,qp)*BF(elem,node,qp)*(dUdJ - pressure(elem,qp))/K;
       }
 
-      for (unsigned qp=0; qp < num_qps; ++qp) {
+      for (unsigned qp=0; qp < nq; ++qp) {
         double h = size(elem, qp);
         ScalarT param = 0.5*alpha*h*h / G;
-        for (unsigned node=0; node < num_nodes; ++node)
-        for (unsigned i=0; i < num_dims; ++i)
+        for (unsigned node=0; node < nn; ++node)
+        for (unsigned i=0; i < nd; ++i)
           resid(elem, node) -= param * wDv(elem,qp) *
             gBF(elem,node,qp,i)*pressure_grad(elem,qp,i);
       }
-    }
+    });
   }
 
   else {
 
-    for (unsigned elem=0; elem < workset.size; ++elem) {
-      for (unsigned node=0; node < num_nodes; ++node)
+    parallel_elems(ws_size, [=] (int elem) {
+      Intrepid2::Tensor<ScalarT, D> sigma(nd);
+      Intrepid2::Tensor<ScalarT, D> F(nd);
+      Intrepid2::Tensor<ScalarT, D> Cinv(nd);
+      for (unsigned node=0; node < nn; ++node)
         resid(elem, node) = 0.0;
-      for (unsigned qp=0; qp < num_qps; ++qp) {
-        for (unsigned i=0; i < num_dims; ++i)
-        for (unsigned j=0; j < num_dims; ++j)
+      for (unsigned qp=0; qp < nq; ++qp) {
+        for (unsigned i=0; i < nd; ++i)
+        for (unsigned j=0; j < nd; ++j)
           sigma(i,j) = stress(elem,qp,i,j);
-        ScalarT dUdJ = (1.0/num_dims)*Intrepid2::trace(sigma);
-        for (unsigned node=0; node < num_nodes; ++node)
+        ScalarT dUdJ = (1.0/nd)*Intrepid2::trace(sigma);
+        for (unsigned node=0; node < nn; ++node)
           resid(elem,node) +=
             wDv(elem,qp)*BF(elem,node,qp)*(dUdJ - pressure(elem,qp))/K;
       }
 
-      for (unsigned qp=0; qp < num_qps; ++qp) {
+      for (unsigned qp=0; qp < nq; ++qp) {
         ScalarT J = det_def_grad(elem, qp);
-        for (unsigned i=0; i < num_dims; ++i)
-        for (unsigned j=0; j < num_dims; ++j)
+        for (unsigned i=0; i < nd; ++i)
+        for (unsigned j=0; j < nd; ++j)
           F(i,j) = def_grad(elem,qp,i,j);
         Cinv = Intrepid2::inverse(Intrepid2::transpose(F)*F);
         double h = size(elem, qp);
         ScalarT param = 0.5*alpha*h*h / G;
-        for (unsigned node=0; node < num_nodes; ++node)
-        for (unsigned i=0; i < num_dims; ++i)
-        for (unsigned j=0; j < num_dims; ++j)
+        for (unsigned node=0; node < nn; ++node)
+        for (unsigned i=0; i < nd; ++i)
+        for (unsigned j=0; j < nd; ++j)
           resid(elem,node) -= param * wDv(elem, qp) * J * Cinv(i,j) *
             pressure_grad(elem,qp,i) * gBF(elem,node,qp,j);
       }
-    }
+    });
   }
 
 }
 
+PHX_EVALUATE_FIELDS(PressureResidual, workset)
+{
+  GOAL_DISPATCH_KERNEL(num_nodes, num_qps, num_dims,
+      this->template compute, workset.size);
+}
+
 GOAL_INSTANTIATE_ALL(PressureResidual)
 
 }
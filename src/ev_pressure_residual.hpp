@@ -39,6 +39,9 @@ PHX_EVALUATOR_CLASS(PressureResidual)
     PHX::MDField<ScalarT, Elem, QP, Dim> pressure_grad;
     PHX::MDField<ScalarT, Elem, Node> resid;
 
+    template <unsigned N, unsigned Q, unsigned D>
+    void compute(unsigned ws_size);
+
 PHX_EVALUATOR_CLASS_END
 
 }
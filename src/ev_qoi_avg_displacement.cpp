@@ -16,6 +16,10 @@ PHX_EVALUATOR_CTOR(QoIAvgDisplacement, p) :
   num_qps = dl->node_qp_vector->dimension(2);
   num_dims = dl->node_qp_vector->dimension(3);
 
+  component = -1;
+  if (p.isParameter("Component"))
+    component = p.get<int>("Component");
+
   disp.resize(num_dims);
   for (unsigned i=0; i < num_dims; ++i) {
     get_field(disp_names[i], dl, disp[i]);
@@ -37,12 +41,14 @@ PHX_POST_REGISTRATION_SETUP(QoIAvgDisplacement, data, fm)
 
 PHX_EVALUATE_FIELDS(QoIAvgDisplacement, workset)
 {
+  unsigned begin = (component < 0) ? 0 : component;
+  unsigned end = (component < 0) ? num_dims : component + 1;
   for (unsigned elem=0; elem < workset.size; ++elem) {
     avg_disp(elem) = 0.0;
     for (unsigned qp=0; qp < num_qps; ++qp)
-    for (unsigned i=0; i < num_dims; ++i)
+    for (unsigned i=begin; i < end; ++i)
       avg_disp(elem) += disp[i](elem, qp) * wDv(elem, qp);
-    avg_disp(elem) /= num_dims;
+    avg_disp(elem) /= (end - begin);
   }
 }
 
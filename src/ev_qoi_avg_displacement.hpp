@@ -21,6 +21,8 @@ PHX_EVALUATOR_CLASS(QoIAvgDisplacement)
     unsigned num_nodes;
     unsigned num_qps;
 
+    int component; /* -1 averages all components */
+
     Teuchos::Array<std::string> disp_names;
 
     PHX::MDField<double, Elem, QP> wDv;
@@ -14,7 +14,7 @@ ScatterQoI(ParameterList const& p) :
   dl      (p.get<RCP<Layouts> >("Layouts")),
   qoi     (p.get<std::string>("QoI Name"), dl->elem_scalar)
 {
-  std::string name = "Scatter QoI";
+  std::string name = "Scatter QoI: " + qoi.fieldTag().name();
   PHX::Tag<ScalarT> op(name, dl->dummy);
   this->addDependentField(qoi);
   this->addEvaluatedField(op);
@@ -36,24 +36,25 @@ evaluateFields(typename Traits::EvalData workset)
 {
 }
 
-template <typename Traits>
-ScatterQoI<GoalTraits::Derivative, Traits>::
+template <int N, typename Traits>
+ScatterQoI<GoalTraits::DerivativeN<N>, Traits>::
 ScatterQoI(ParameterList const& p) :
   dl      (p.get<RCP<Layouts> >("Layouts")),
   mesh    (p.get<RCP<Mesh> >("Mesh")),
-  qoi     (p.get<std::string>("QoI Name"), dl->elem_scalar)
+  qoi     (p.get<std::string>("QoI Name"), dl->elem_scalar),
+  index   (p.get<unsigned>("QoI Index"))
 {
   num_nodes = dl->node_scalar->dimension(1);
 
-  std::string name = "Scatter QoI";
+  std::string name = "Scatter QoI: " + qoi.fieldTag().name();
   PHX::Tag<ScalarT> op(name, dl->dummy);
   this->addDependentField(qoi);
   this->addEvaluatedField(op);
   this->setName(name);
 }
 
-template <typename Traits>
-void ScatterQoI<GoalTraits::Derivative, Traits>::
+template <int N, typename Traits>
+void ScatterQoI<GoalTraits::DerivativeN<N>, Traits>::
 postRegistrationSetup(
     typename Traits::SetupData d,
     PHX::FieldManager<Traits>& fm)
@@ -61,12 +62,13 @@ postRegistrationSetup(
   this->utils.setFieldData(qoi, fm);
 }
 
-template <typename Traits>
-void ScatterQoI<GoalTraits::Derivative, Traits>::
+template <int N, typename Traits>
+void ScatterQoI<GoalTraits::DerivativeN<N>, Traits>::
 evaluateFields(typename Traits::EvalData workset)
 {
   CHECK(workset.q != Teuchos::null);
-  ArrayRCP<ST> dqdu = workset.q->get1dViewNonConst();
+  CHECK(index < workset.q->getNumVectors());
+  ArrayRCP<ST> dqdu = workset.q->getDataNonConst(index);
   CHECK(dqdu != Teuchos::null);
 
   unsigned num_eqs = mesh->get_num_eqs();
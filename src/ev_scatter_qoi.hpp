@@ -37,10 +37,10 @@ class ScatterQoI<GoalTraits::Forward, Traits> :
     PHX::MDField<ScalarT, Elem> qoi;
 };
 
-template <typename Traits>
-class ScatterQoI<GoalTraits::Derivative, Traits> :
+template <int N, typename Traits>
+class ScatterQoI<GoalTraits::DerivativeN<N>, Traits> :
   public PHX::EvaluatorWithBaseImpl<Traits>,
-  public PHX::EvaluatorDerived<GoalTraits::Derivative, Traits>
+  public PHX::EvaluatorDerived<GoalTraits::DerivativeN<N>, Traits>
 {
   public:
 
@@ -54,12 +54,13 @@ class ScatterQoI<GoalTraits::Derivative, Traits> :
 
   private:
 
-    typedef typename GoalTraits::Derivative::ScalarT ScalarT;
+    typedef typename GoalTraits::DerivativeN<N>::ScalarT ScalarT;
 
     RCP<Layouts> dl;
     RCP<Mesh> mesh;
 
     unsigned num_nodes;
+    unsigned index;
 
     PHX::MDField<ScalarT, Elem> qoi;
 };
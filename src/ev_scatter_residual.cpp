@@ -4,6 +4,7 @@
 #include "workset.hpp"
 #include "layouts.hpp"
 #include "phx_utils.hpp"
+#include "parallel_elems.hpp"
 
 namespace goal {
 
@@ -50,19 +51,21 @@ evaluateFields(typename Traits::EvalData workset)
   ArrayRCP<ST> r = workset.r->get1dViewNonConst();
   CHECK(r != Teuchos::null);
 
-  for (unsigned elem=0; elem < workset.size; ++elem) {
-    apf::MeshEntity* e= workset.ents[elem];
+  /* elements that share a node add into the same entry */
+  ST* rp = r.getRawPtr();
+  LO const* lids = mesh->get_elem_lids(workset.set, workset.ws_idx).data();
+  parallel_elems(workset.size, [=] (int elem) {
     for (unsigned node=0; node < num_nodes; ++node) {
       for (unsigned eq=0; eq < num_eqs; ++eq) {
-        LO lid = mesh->get_lid(e, node, eq);
-        r[lid] += resid[eq](elem, node);
+        LO lid = lids[(elem*num_nodes + node)*num_eqs + eq];
+        Kokkos::atomic_add(&rp[lid], resid[eq](elem, node));
       }
     }
-  }
+  });
 }
 
-template <typename Traits>
-ScatterResidual<GoalTraits::Derivative, Traits>::
+template <int N, typename Traits>
+ScatterResidual<GoalTraits::DerivativeN<N>, Traits>::
 ScatterResidual(ParameterList const& p) :
   dl        (p.get<RCP<Layouts> >("Layouts")),
   mesh      (p.get<RCP<Mesh> >("Mesh")),
@@ -84,8 +87,8 @@ ScatterResidual(ParameterList const& p) :
   this->setName(name);
 }
 
-template <typename Traits>
-void ScatterResidual<GoalTraits::Derivative, Traits>::
+template <int N, typename Traits>
+void ScatterResidual<GoalTraits::DerivativeN<N>, Traits>::
 postRegistrationSetup(
     typename Traits::SetupData d,
     PHX::FieldManager<Traits>& fm)
@@ -94,66 +97,56 @@ postRegistrationSetup(
     this->utils.setFieldData(resid[i], fm);
 }
 
-template <typename Traits>
-void ScatterResidual<GoalTraits::Derivative, Traits>::
+template <int N, typename Traits>
+void ScatterResidual<GoalTraits::DerivativeN<N>, Traits>::
 evaluateFields(typename Traits::EvalData workset)
 {
   CHECK(workset.J != Teuchos::null);
-  RCP<Matrix> J = workset.J;
+  Matrix* J = workset.J.get();
 
-  bool fill_resid = false;
-  ArrayRCP<ST> r;
+  ST* r = 0;
+  ArrayRCP<ST> rv;
   if (workset.r != Teuchos::null) {
-    fill_resid = true;
-    r = workset.r->get1dViewNonConst();
-    CHECK(r != Teuchos::null);
+    rv = workset.r->get1dViewNonConst();
+    CHECK(rv != Teuchos::null);
+    r = rv.getRawPtr();
   }
 
-  Teuchos::Array<LO> cols(num_dofs);
+  /* elements that share a node add into the same rows, so the
+     matrix and residual sums are atomic */
+  LO const* lids = mesh->get_elem_lids(workset.set, workset.ws_idx).data();
 
   if (! workset.is_adjoint) {
-    for (unsigned elem=0; elem < workset.size; ++elem) {
-      apf::MeshEntity* e = workset.ents[elem];
-      unsigned idx=0;
-      for (unsigned node=0; node < num_nodes; ++node) {
-        for (unsigned eq=0; eq < num_eqs; ++eq) {
-          cols[idx] = mesh->get_lid(e, node, eq);
-          idx++;
-        }
-      }
+    parallel_elems(workset.size, [=] (int elem) {
+      LO const* cols = lids + elem*num_dofs;
       for (unsigned node=0; node < num_nodes; ++node) {
         for (unsigned eq=0; eq < num_eqs; ++eq) {
-          LO row = mesh->get_lid(e, node, eq);
-          FadType v = resid[eq](elem, node);
-          J->sumIntoLocalValues(
-              row, cols, arrayView(&(v.fastAccessDx(0)), num_dofs));
-          if (fill_resid)
-            r[row] += resid[eq](elem, node).val();
+          LO row = cols[node*num_eqs + eq];
+          ScalarT const& v = resid[eq](elem, node);
+          J->sumIntoLocalValues(row, arrayView(cols, num_dofs),
+              arrayView(&(v.fastAccessDx(0)), num_dofs), true);
+          if (r)
+            Kokkos::atomic_add(&r[row], v.val());
         }
       }
-    }
+    });
   }
 
   else {
-    for (unsigned elem=0; elem < workset.size; ++elem) {
-      apf::MeshEntity* e = workset.ents[elem];
-      unsigned idx=0;
+    parallel_elems(workset.size, [=] (int elem) {
+      LO const* cols = lids + elem*num_dofs;
       for (unsigned node=0; node < num_nodes; ++node) {
         for (unsigned eq=0; eq < num_eqs; ++eq) {
-          cols[idx] = mesh->get_lid(e, node, eq);
-          idx++;
-        }
-      }
-      for (unsigned node=0; node < num_nodes; ++node) {
-        for (unsigned eq=0; eq < num_eqs; ++eq) {
-          LO row = mesh->get_lid(e, node, eq);
-          FadType v = resid[eq](elem, node);
+          LO row = cols[node*num_eqs + eq];
+          ScalarT const& v = resid[eq](elem, node);
           for (unsigned dof=0; dof < num_dofs; ++dof)
             J->sumIntoLocalValues(cols[dof], arrayView(&row, 1),
-                arrayView(&(v.fastAccessDx(dof)), 1));
+                arrayView(&(v.fastAccessDx(dof)), 1), true);
+          if (r)
+            Kokkos::atomic_add(&r[row], v.val());
         }
       }
-    }
+    });
   }
 }
 
@@ -42,10 +42,10 @@ class ScatterResidual<GoalTraits::Forward, Traits> :
     std::vector<PHX::MDField<ScalarT, Elem, Node> > resid;
 };
 
-template <typename Traits>
-class ScatterResidual<GoalTraits::Derivative, Traits> :
+template <int N, typename Traits>
+class ScatterResidual<GoalTraits::DerivativeN<N>, Traits> :
   public PHX::EvaluatorWithBaseImpl<Traits>,
-  public PHX::EvaluatorDerived<GoalTraits::Derivative, Traits>
+  public PHX::EvaluatorDerived<GoalTraits::DerivativeN<N>, Traits>
 {
   public:
 
@@ -59,7 +59,7 @@ class ScatterResidual<GoalTraits::Derivative, Traits> :
 
   private:
 
-    typedef typename GoalTraits::Derivative::ScalarT ScalarT;
+    typedef typename GoalTraits::DerivativeN<N>::ScalarT ScalarT;
 
     RCP<Layouts> dl;
     RCP<Mesh> mesh;
@@ -0,0 +1,37 @@
+#ifndef goal_kernel_sizes_hpp
+#define goal_kernel_sizes_hpp
+
+namespace goal {
+
+/* returns the compile-time size S of a kernel dimension,
+   or the runtime size if the kernel was not specialized (S=0).
+   with S known the compiler can unroll and vectorize the
+   node, qp and dim loops of the hot evaluators. */
+template <unsigned S>
+inline unsigned kernel_size(unsigned runtime)
+{
+  return (S != 0) ? S : runtime;
+}
+
+}
+
+/* calls KERNEL<N,Q,D>(...) specialized for the common element
+   types: 2D triangles and 3D tetrahedra with P1 or P2 hierarchic
+   fields integrated with the matching quadrature order. other
+   sizes fall back to KERNEL<0,0,0>(...), which reads them at
+   runtime. KERNEL is typically `this->template name`. */
+#define GOAL_DISPATCH_KERNEL(NODES, QPS, DIMS, KERNEL, ...)  \
+  do {                                                       \
+    if ((DIMS) == 2 && (NODES) == 3 && (QPS) == 1)           \
+      KERNEL<3,1,2>(__VA_ARGS__);                            \
+    else if ((DIMS) == 2 && (NODES) == 6 && (QPS) == 3)      \
+      KERNEL<6,3,2>(__VA_ARGS__);                            \
+    else if ((DIMS) == 3 && (NODES) == 4 && (QPS) == 1)      \
+      KERNEL<4,1,3>(__VA_ARGS__);                            \
+    else if ((DIMS) == 3 && (NODES) == 10 && (QPS) == 4)     \
+      KERNEL<10,4,3>(__VA_ARGS__);                           \
+    else                                                     \
+      KERNEL<0,0,0>(__VA_ARGS__);                            \
+  } while (0)
+
+#endif
@@ -13,6 +13,7 @@ Layouts::Layouts()
   qp_scalar = rcp(new MDALayout<Dummy>(0));
   qp_vector = rcp(new MDALayout<Dummy>(0));
   qp_tensor = rcp(new MDALayout<Dummy>(0));
+  qp_tensor4 = rcp(new MDALayout<Dummy>(0));
   node_qp_scalar = rcp(new MDALayout<Dummy>(0));
   node_qp_vector = rcp(new MDALayout<Dummy>(0));
   dummy = rcp(new MDALayout<Dummy>(0));
@@ -26,6 +27,7 @@ Layouts::Layouts(size_t ws_size, size_t n_nodes, size_t n_qps, size_t n_dims)
   qp_scalar = rcp(new MDALayout<Elem, QP>(ws_size, n_qps));
   qp_vector = rcp(new MDALayout<Elem, QP, Dim>(ws_size, n_qps, n_dims));
   qp_tensor = rcp(new MDALayout<Elem, QP, Dim, Dim>(ws_size, n_qps, n_dims, n_dims));
+  qp_tensor4 = rcp(new MDALayout<Elem, QP, Dim, Dim, Dim, Dim>(ws_size, n_qps, n_dims, n_dims, n_dims, n_dims));
   node_qp_scalar = rcp(new MDALayout<Elem, Node, QP>(ws_size, n_nodes, n_qps));
   node_qp_vector = rcp(new MDALayout<Elem, Node, QP, Dim>(ws_size, n_nodes, n_qps, n_dims));
   dummy = rcp(new MDALayout<Dummy>(0));
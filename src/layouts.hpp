@@ -19,6 +19,7 @@ struct Layouts
   RCP<PHX::DataLayout> qp_scalar;
   RCP<PHX::DataLayout> qp_vector;
   RCP<PHX::DataLayout> qp_tensor;
+  RCP<PHX::DataLayout> qp_tensor4;
   RCP<PHX::DataLayout> node_qp_scalar;
   RCP<PHX::DataLayout> node_qp_vector;
   RCP<PHX::DataLayout> dummy;
@@ -1,11 +1,21 @@
 #include "linear_solver.hpp"
+#include "block_preconditioner.hpp"
+#include "single_preconditioner.hpp"
+#include "pmg_preconditioner.hpp"
+#include "lowsync_gmres.hpp"
 #include "control.hpp"
 
 #include <BelosLinearProblem.hpp>
 #include <BelosBlockGmresSolMgr.hpp>
+#include <BelosGCRODRSolMgr.hpp>
+#include <BelosPseudoBlockCGSolMgr.hpp>
 #include <BelosTpetraAdapter.hpp>
 #include <Ifpack2_Factory.hpp>
 
+#ifdef GOAL_ENABLE_DIRECT
+#include <Amesos2.hpp>
+#endif
+
 namespace goal {
 
 typedef Tpetra::MultiVector<ST, LO, GO, KNode> MV;
@@ -14,6 +24,8 @@ typedef Tpetra::RowMatrix<ST, LO, GO, KNode> RM;
 typedef Belos::LinearProblem<ST, MV, OP> LinearProblem;
 typedef Belos::SolverManager<ST, MV, OP> Solver;
 typedef Belos::BlockGmresSolMgr<ST, MV, OP> GmresSolver;
+typedef Belos::GCRODRSolMgr<ST, MV, OP> GcrodrSolver;
+typedef Belos::PseudoBlockCGSolMgr<ST, MV, OP> CgSolver;
 typedef Tpetra::Operator<ST, LO, GO, KNode> Prec;
 typedef Ifpack2::Preconditioner<ST, LO, GO, KNode> IfpackPrec;
 
@@ -25,7 +37,36 @@ static RCP<ParameterList> get_ifpack2_params()
   return p;
 }
 
-static RCP<ParameterList> get_belos_params(RCP<const ParameterList> in)
+/* with a nonzero initial guess the tolerance must be relative to the
+   right hand side, otherwise a good guess only tightens the solve. */
+static void set_residual_scaling(bool nonzero_guess, RCP<ParameterList> p)
+{
+  if (! nonzero_guess) return;
+  p->set("Implicit Residual Scaling", "Norm of RHS");
+  p->set("Explicit Residual Scaling", "Norm of RHS");
+}
+
+static std::string get_ortho_name(RCP<const ParameterList> in)
+{
+  std::string ortho = "dgks";
+  if (in->isParameter("linear: orthogonalization"))
+    ortho = in->get<std::string>("linear: orthogonalization");
+  return ortho;
+}
+
+/* belos names for the orthogonalization choices of belos solvers */
+static std::string get_ortho(RCP<const ParameterList> in)
+{
+  std::string ortho = get_ortho_name(in);
+  if (ortho == "dgks") return "DGKS";
+  if (ortho == "icgs") return "ICGS";
+  if (ortho == "imgs") return "IMGS";
+  fail("unknown orthogonalization: %s", ortho.c_str());
+}
+
+static RCP<ParameterList> get_belos_params(
+    RCP<const ParameterList> in,
+    bool guess)
 {
   RCP<ParameterList> p = rcp(new ParameterList);
   int max_iters = in->get<unsigned>("linear: max iters");
@@ -35,7 +76,42 @@ static RCP<ParameterList> get_belos_params(RCP<const ParameterList> in)
   p->set("Num Blocks", krylov);
   p->set("Maximum Iterations", max_iters);
   p->set("Convergence Tolerance", tol);
-  p->set("Orthogonalization", "DGKS");
+  p->set("Orthogonalization", get_ortho(in));
+  set_residual_scaling(guess, p);
+  return p;
+}
+
+static RCP<ParameterList> get_cg_params(
+    RCP<const ParameterList> in,
+    bool guess)
+{
+  RCP<ParameterList> p = rcp(new ParameterList);
+  int max_iters = in->get<unsigned>("linear: max iters");
+  double tol = in->get<double>("linear: tolerance");
+  p->set("Maximum Iterations", max_iters);
+  p->set("Convergence Tolerance", tol);
+  set_residual_scaling(guess, p);
+  return p;
+}
+
+static RCP<ParameterList> get_gcrodr_params(
+    RCP<const ParameterList> in,
+    bool guess)
+{
+  RCP<ParameterList> p = rcp(new ParameterList);
+  int max_iters = in->get<unsigned>("linear: max iters");
+  int krylov = in->get<unsigned>("linear: krylov size");
+  double tol = in->get<double>("linear: tolerance");
+  int recycle = 20;
+  if (in->isParameter("linear: recycle size"))
+    recycle = in->get<unsigned>("linear: recycle size");
+  CHECK(recycle < krylov);
+  p->set("Num Blocks", krylov);
+  p->set("Num Recycled Blocks", recycle);
+  p->set("Maximum Iterations", max_iters);
+  p->set("Convergence Tolerance", tol);
+  p->set("Orthogonalization", get_ortho(in));
+  set_residual_scaling(guess, p);
   return p;
 }
 
@@ -50,20 +126,84 @@ static RCP<Prec> build_ifpack2_prec(RCP<Matrix> A)
   return prec;
 }
 
-static RCP<Prec> build_precond(RCP<const ParameterList> p, RCP<Matrix> A)
+/* additive schwarz with an riluk subdomain solve. unlike ilut, the
+   riluk factors have a fixed level-based pattern, so the subdomain
+   setup and triangular solves can run over the node's threads. */
+static RCP<ParameterList> get_schwarz_params(RCP<const ParameterList> in)
 {
-  (void)(p);
-  return build_ifpack2_prec(A);
+  int overlap = 1;
+  int fill = 1;
+  if (in->isParameter("linear: overlap"))
+    overlap = in->get<unsigned>("linear: overlap");
+  if (in->isParameter("linear: level of fill"))
+    fill = in->get<unsigned>("linear: level of fill");
+  RCP<ParameterList> p = rcp(new ParameterList);
+  p->set("schwarz: overlap level", overlap);
+  p->set("schwarz: combine mode", "ADD");
+  p->set("schwarz: use reordering", false);
+  p->set("inner preconditioner name", "RILUK");
+  ParameterList& inner = p->sublist("inner preconditioner parameters");
+  inner.set("fact: iluk level-of-fill", fill);
+  return p;
+}
+
+static RCP<Prec> build_schwarz_prec(
+    RCP<const ParameterList> in,
+    RCP<Matrix> A)
+{
+  RCP<ParameterList> p = get_schwarz_params(in);
+  Ifpack2::Factory factory;
+  RCP<IfpackPrec> prec = factory.create<RM>("SCHWARZ", A);
+  prec->setParameters(*p);
+  prec->initialize();
+  prec->compute();
+  return prec;
+}
+
+static RCP<Prec> build_single_prec(RCP<Matrix> A)
+{
+#ifdef GOAL_MIXED_PRECISION
+  RCP<ParameterList> p = get_ifpack2_params();
+  return rcp(new SinglePreconditioner(A, "ILUT", p));
+#else
+  (void)(A);
+  fail("single precision preconditioners require GOAL_MIXED_PRECISION=ON");
+#endif
+}
+
+static RCP<Prec> build_block_prec(
+    RCP<Matrix> A,
+    unsigned num_eqs,
+    unsigned offset)
+{
+  RCP<ParameterList> p = get_ifpack2_params();
+  return rcp(new BlockPreconditioner(A, p, num_eqs, offset));
+}
+
+/* when the current space is the coarse space there is nothing to
+   coarsen, so the fine level smoother is used on its own. */
+static RCP<Prec> build_pmg_prec(
+    RCP<Matrix> A,
+    RCP<const Map> coarse_map)
+{
+  if (coarse_map == Teuchos::null)
+    fail("p-multigrid preconditioner requires a coarse map");
+  if (coarse_map->getGlobalNumElements() == A->getGlobalNumRows())
+    return build_ifpack2_prec(A);
+  RCP<ParameterList> p = get_ifpack2_params();
+  return rcp(new PMultigridPreconditioner(A, coarse_map, p));
 }
 
 static RCP<Solver> build_solver(
     RCP<const ParameterList> in,
+    bool guess,
     RCP<Prec> P,
     RCP<Matrix> A,
-    RCP<Vector> x,
-    RCP<Vector> b)
+    RCP<MultiVector> x,
+    RCP<MultiVector> b)
 {
-  RCP<ParameterList> p = get_belos_params(in);
+  RCP<ParameterList> p = get_belos_params(in, guess);
+  p->set("Block Size", int(x->getNumVectors()));
   RCP<LinearProblem> problem = rcp(new LinearProblem(A,x,b));
   problem->setLeftPrec(P);
   problem->setProblem();
@@ -71,19 +211,263 @@ static RCP<Solver> build_solver(
   return solver;
 }
 
-void solve_linear_system(
+/* cg needs a symmetric system, e.g. with the symmetric dirichlet
+   elimination, and a symmetric preconditioner. */
+static RCP<Solver> build_cg_solver(
+    RCP<const ParameterList> in,
+    bool guess,
+    RCP<Prec> P,
+    RCP<Matrix> A,
+    RCP<MultiVector> x,
+    RCP<MultiVector> b)
+{
+  RCP<ParameterList> p = get_cg_params(in, guess);
+  RCP<LinearProblem> problem = rcp(new LinearProblem(A,x,b));
+  problem->setLeftPrec(P);
+  problem->setProblem();
+  RCP<Solver> solver = rcp(new CgSolver(problem, p));
+  return solver;
+}
+
+/* the recycled subspace lives in the solver manager, so the same
+   manager is handed each new problem until the map changes. */
+static RCP<Solver> build_recycling_solver(
     RCP<const ParameterList> in,
+    bool guess,
+    RCP<Solver>& recycler,
+    RCP<Prec> P,
     RCP<Matrix> A,
-    RCP<Vector> x,
-    RCP<Vector> b)
+    RCP<MultiVector> x,
+    RCP<MultiVector> b)
 {
+  RCP<LinearProblem> problem = rcp(new LinearProblem(A,x,b));
+  problem->setRightPrec(P);
+  problem->setProblem();
+  if (recycler == Teuchos::null) {
+    RCP<ParameterList> p = get_gcrodr_params(in, guess);
+    recycler = rcp(new GcrodrSolver(problem, p));
+  }
+  else
+    recycler->setProblem(problem);
+  return recycler;
+}
+
+LinearSolver::LinearSolver(RCP<const ParameterList> p) :
+  params(p),
+  type("gmres"),
+  prec_type("ilut"),
+  single_prec(false),
+  block_eqs(0),
+  block_offset(0),
+  reuse(false),
+  nonzero_guess(false),
+  tolerance(0.0),
+  num_iters(0),
+  num_reductions(0),
+  num_single_applies(0),
+  direct_type("KLU2")
+{
+  if (params->isParameter("linear: solver"))
+    type = params->get<std::string>("linear: solver");
+  if (params->isParameter("linear: preconditioner"))
+    prec_type = params->get<std::string>("linear: preconditioner");
+  if (params->isParameter("linear: single precision"))
+    single_prec = params->get<bool>("linear: single precision");
+  if (params->isParameter("linear: direct solver"))
+    direct_type = params->get<std::string>("linear: direct solver");
+  if (params->isParameter("linear: guess history"))
+    nonzero_guess = (params->get<unsigned>("linear: guess history") > 0);
+  if ((type != "gmres") &&
+      (type != "gcrodr") &&
+      (type != "cg") &&
+      (type != "direct"))
+    fail("unknown linear solver: %s", type.c_str());
+#ifdef GOAL_ENABLE_DIRECT
+  if ((type == "direct") && (! Amesos2::query(direct_type)))
+    fail("amesos2 direct solver not enabled: %s", direct_type.c_str());
+#else
+  if (type == "direct")
+    fail("direct solvers require a Trilinos build with Amesos2");
+#endif
+  /* gmres with icgs or dcgs2 runs the counted gram-schmidt solver */
+  std::string ortho = get_ortho_name(params);
+  if ((ortho != "dgks") &&
+      (ortho != "icgs") &&
+      (ortho != "imgs") &&
+      (ortho != "dcgs2"))
+    fail("unknown orthogonalization: %s", ortho.c_str());
+  if ((type == "gmres") && ((ortho == "icgs") || (ortho == "dcgs2")))
+    lowsync = rcp(new LowSyncGmres(ortho,
+          params->get<unsigned>("linear: krylov size"),
+          params->get<unsigned>("linear: max iters")));
+  else if (ortho == "dcgs2")
+    fail("dcgs2 orthogonalization requires the gmres solver");
+  if ((prec_type != "ilut") &&
+      (prec_type != "block") &&
+      (prec_type != "schwarz") &&
+      (prec_type != "pmg"))
+    fail("unknown preconditioner: %s", prec_type.c_str());
+  if (single_prec && ((prec_type != "ilut") || (type == "direct")))
+    fail("single precision requires the ilut preconditioner "
+         "and an iterative solver");
+}
+
+void LinearSolver::set_block_split(unsigned num_eqs, unsigned offset)
+{
+  block_eqs = num_eqs;
+  block_offset = offset;
+}
+
+RCP<Prec> LinearSolver::build_precond(RCP<Matrix> A)
+{
+  if (prec_type == "block") {
+    if (block_eqs == 0)
+      fail("block preconditioner requires a mixed formulation");
+    return build_block_prec(A, block_eqs, block_offset);
+  }
+  if (prec_type == "schwarz")
+    return build_schwarz_prec(params, A);
+  if (prec_type == "pmg")
+    return build_pmg_prec(A, coarse_map);
+  if (single_prec)
+    return build_single_prec(A);
+  return build_ifpack2_prec(A);
+}
+
+void LinearSolver::reset()
+{
+  if (recycler != Teuchos::null)
+    print("  recycled krylov subspace reset");
+  recycler = Teuchos::null;
+  map = Teuchos::null;
+  prec = Teuchos::null;
+  direct = Teuchos::null;
+  direct_graph = Teuchos::null;
+}
+
+/* the symbolic factorization depends only on the graph, so it is
+   kept until the jacobian is built on a new graph. */
+void LinearSolver::solve_direct(
+    RCP<Matrix> A,
+    RCP<MultiVector> x,
+    RCP<MultiVector> b)
+{
+#ifdef GOAL_ENABLE_DIRECT
   double t0 = time();
-  RCP<Prec> P = build_precond(in, A);
-  RCP<Solver> solver = build_solver(in, P, A, x, b);
+  bool refactor = (! reuse);
+  if (A->getCrsGraph() != direct_graph) {
+    direct = Amesos2::create<Matrix, MultiVector>(direct_type, A);
+    direct->symbolicFactorization();
+    direct_graph = A->getCrsGraph();
+    refactor = true;
+    print("  symbolic factorization computed in %f seconds", time()-t0);
+  }
+  else if (refactor)
+    direct->setA(A, Amesos2::SYMBFACT);
+  if (refactor)
+    direct->numericFactorization();
+  double t1 = time();
+  direct->solve(
+      Teuchos::ptr<MultiVector>(x.get()),
+      Teuchos::ptr<const MultiVector>(b.get()));
+  double t2 = time();
+  if (refactor)
+    print("  numeric factorization computed in %f seconds", t1-t0);
+  else
+    print("  reusing the numeric factorization");
+  print("  linear system solved directly in %f seconds", t2-t0);
+#else
+  (void)(A);
+  (void)(x);
+  (void)(b);
+  fail("direct solvers require a Trilinos build with Amesos2");
+#endif
+}
+
+/* the applies made by a single precision preconditioner so far */
+static unsigned count_single_applies(RCP<Prec> P)
+{
+#ifdef GOAL_MIXED_PRECISION
+  RCP<SinglePreconditioner> single =
+    Teuchos::rcp_dynamic_cast<SinglePreconditioner>(P);
+  if (single != Teuchos::null)
+    return single->get_num_applies();
+#else
+  (void)(P);
+#endif
+  return 0;
+}
+
+/* the reductions are counted by the solver as it makes them */
+void LinearSolver::solve_lowsync(
+    RCP<Matrix> A,
+    RCP<MultiVector> x,
+    RCP<MultiVector> b)
+{
+  double t0 = time();
+  double tol = params->get<double>("linear: tolerance");
+  if (tolerance > 0.0) tol = tolerance;
+  lowsync->solve(A, prec, x, b, tol, nonzero_guess);
+  num_iters = lowsync->get_num_iters();
+  num_reductions = lowsync->get_num_reductions();
+  double t1 = time();
+  if (num_iters >= params->get<unsigned>("linear: max iters"))
+    print("  linear solve failed to converge in %d iterations\n"
+          "  continuing using the incomplete solve...", num_iters);
+  else
+    print("  linear system solved in %d iterations", num_iters);
+  print("  %s used %d global reductions",
+      get_ortho_name(params).c_str(), num_reductions);
+  print("  linear system solved in %f seconds", t1-t0);
+}
+
+void LinearSolver::solve(
+    RCP<Matrix> A,
+    RCP<MultiVector> x,
+    RCP<MultiVector> b)
+{
+  double t0 = time();
+  if (A->getRowMap() != map) {
+    reset();
+    map = A->getRowMap();
+  }
+  num_iters = 0;
+  num_reductions = 0;
+  num_single_applies = 0;
+  if (type == "direct")
+    return solve_direct(A, x, b);
+  if ((type == "gcrodr") && (x->getNumVectors() > 1))
+    fail("gcrodr recycling supports a single right hand side");
+  if ((! reuse) || (prec == Teuchos::null))
+    prec = build_precond(A);
+  else
+    print("  reusing the preconditioner");
+  RCP<Prec> P = prec;
+  unsigned single_applies = count_single_applies(P);
+  if (lowsync != Teuchos::null) {
+    solve_lowsync(A, x, b);
+    num_single_applies = count_single_applies(P) - single_applies;
+    return;
+  }
+  RCP<Solver> solver;
+  if (type == "gcrodr")
+    solver = build_recycling_solver(
+        params, nonzero_guess, recycler, P, A, x, b);
+  else if (type == "cg")
+    solver = build_cg_solver(params, nonzero_guess, P, A, x, b);
+  else
+    solver = build_solver(params, nonzero_guess, P, A, x, b);
+  if (tolerance > 0.0) {
+    RCP<ParameterList> tp = rcp(new ParameterList);
+    tp->set("Convergence Tolerance", tolerance);
+    solver->setParameters(tp);
+  }
   solver->solve();
+  num_single_applies = count_single_applies(P) - single_applies;
   unsigned iters = solver->getNumIters();
+  num_iters = iters;
   double t1 = time();
-  if (iters >= in->get<unsigned>("linear: max iters"))
+  if (iters >= params->get<unsigned>("linear: max iters"))
     print("  linear solve failed to converge in %d iterations\n"
           "  continuing using the incomplete solve...", iters);
   else
@@ -3,16 +3,86 @@
 
 #include "data_types.hpp"
 
+#include <BelosSolverManager.hpp>
+
+namespace Amesos2 {
+template <class Matrix, class Vector> class Solver;
+}
+
 namespace goal {
 
+class LowSyncGmres;
+
+using Teuchos::rcp;
 using Teuchos::RCP;
 using Teuchos::ParameterList;
 
-void solve_linear_system(
-    RCP<const ParameterList> p,
-    RCP<Matrix> A,
-    RCP<Vector> x,
-    RCP<Vector> b);
+class LinearSolver
+{
+  public:
+
+    LinearSolver(RCP<const ParameterList> p);
+
+    void solve(RCP<Matrix> A, RCP<MultiVector> x, RCP<MultiVector> b);
+
+    void reset();
+
+    void set_block_split(unsigned num_eqs, unsigned offset);
+
+    void set_coarse_map(RCP<const Map> m) {coarse_map = m;}
+
+    void set_reuse(bool r) {reuse = r;}
+
+    void set_nonzero_guess(bool g) {nonzero_guess = g;}
+
+    void set_tolerance(double t) {tolerance = t;}
+
+    unsigned get_num_iters() {return num_iters;}
+
+    bool counts_reductions() {return lowsync != Teuchos::null;}
+
+    unsigned get_num_reductions() {return num_reductions;}
+
+    unsigned get_num_single_applies() {return num_single_applies;}
+
+  private:
+
+    RCP<const ParameterList> params;
+    std::string type;
+    std::string prec_type;
+    bool single_prec;
+
+    unsigned block_eqs;
+    unsigned block_offset;
+
+    RCP<const Map> coarse_map;
+
+    bool reuse;
+    RCP<Operator> prec;
+
+    bool nonzero_guess;
+    double tolerance;
+
+    unsigned num_iters;
+    unsigned num_reductions;
+    unsigned num_single_applies;
+
+    RCP<const Map> map;
+    RCP<Belos::SolverManager<ST, MultiVector, Operator> > recycler;
+
+    std::string direct_type;
+    RCP<const Graph> direct_graph;
+    RCP<Amesos2::Solver<Matrix, MultiVector> > direct;
+
+    RCP<LowSyncGmres> lowsync;
+
+    RCP<Operator> build_precond(RCP<Matrix> A);
+
+    void solve_direct(RCP<Matrix> A, RCP<MultiVector> x, RCP<MultiVector> b);
+
+    void solve_lowsync(RCP<Matrix> A, RCP<MultiVector> x, RCP<MultiVector> b);
+
+};
 
 }
 
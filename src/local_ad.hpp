@@ -0,0 +1,85 @@
+#ifndef goal_local_ad_hpp
+#define goal_local_ad_hpp
+
+#include <Sacado.hpp>
+#include <Intrepid2_MiniTensor.h>
+
+namespace goal {
+
+/* the derivative type of a material update local to a point. it
+   carries d/dF for the num_dims^2 components of the deformation
+   gradient instead of the derivatives of every element dof. */
+typedef Sacado::Fad::SLFad<double, 9> LocalFadType;
+
+template <typename T>
+double get_value(T const& v)
+{
+  return Sacado::ScalarValue<T>::eval(v);
+}
+
+template <typename T>
+Intrepid2::Tensor<double> get_values(Intrepid2::Tensor<T> const& t)
+{
+  unsigned n = t.get_dimension();
+  Intrepid2::Tensor<double> v(n);
+  for (unsigned i=0; i < n; ++i)
+  for (unsigned j=0; j < n; ++j)
+    v(i,j) = get_value(t(i,j));
+  return v;
+}
+
+/* seeds the local deformation gradient with the values of F */
+template <typename ScalarT>
+void seed_local(
+    Intrepid2::Tensor<ScalarT> const& F,
+    Intrepid2::Tensor<LocalFadType>& Fl)
+{
+  unsigned n = F.get_dimension();
+  for (unsigned i=0; i < n; ++i)
+  for (unsigned j=0; j < n; ++j)
+    Fl(i,j) = LocalFadType(n*n, i*n+j, get_value(F(i,j)));
+}
+
+/* chain rules a local result s(F) with derivatives ds/dF into the
+   element derivatives carried by F */
+template <typename ScalarT>
+ScalarT chain_local(
+    LocalFadType const& s,
+    Intrepid2::Tensor<ScalarT> const& F)
+{
+  unsigned n = F.get_dimension();
+  ScalarT r = s.val();
+  for (unsigned a=0; a < n; ++a)
+  for (unsigned b=0; b < n; ++b)
+    r += s.dx(a*n+b) * (F(a,b) - get_value(F(a,b)));
+  return r;
+}
+
+/* an element residual value with room for n derivatives, built
+   directly for models that supply their tangent in closed form */
+template <typename ScalarT>
+ScalarT residual_value(unsigned n, double v)
+{
+  return ScalarT(n, v);
+}
+
+template <>
+inline double residual_value<double>(unsigned, double v)
+{
+  return v;
+}
+
+/* sets derivative i of an element residual, real values have none */
+template <typename ScalarT>
+void set_derivative(ScalarT& r, unsigned i, double d)
+{
+  r.fastAccessDx(i) = d;
+}
+
+inline void set_derivative(double&, unsigned, double)
+{
+}
+
+}
+
+#endif
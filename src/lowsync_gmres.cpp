@@ -0,0 +1,263 @@
+#include "lowsync_gmres.hpp"
+#include "control.hpp"
+
+#include <Teuchos_CommHelpers.hpp>
+
+#include <cmath>
+#include <algorithm>
+
+namespace goal {
+
+LowSyncGmres::LowSyncGmres(
+    std::string const& o,
+    unsigned k,
+    unsigned m) :
+  ortho(o),
+  krylov(k),
+  max_iters(m),
+  num_iters(0),
+  num_reductions(0),
+  iters(0),
+  tol(0.0),
+  scale(0.0),
+  done(false)
+{
+  if ((ortho != "icgs") && (ortho != "dcgs2"))
+    fail("unknown orthogonalization: %s", ortho.c_str());
+  CHECK(krylov > 0);
+}
+
+/* the owned part of an inner product, summed over ranks by sum_all */
+static double local_dot(Vector const& a, Vector const& b)
+{
+  Teuchos::ArrayRCP<const ST> x = a.get1dView();
+  Teuchos::ArrayRCP<const ST> y = b.get1dView();
+  double s = 0.0;
+  for (Teuchos_Ordinal i=0; i < x.size(); ++i)
+    s += x[i]*y[i];
+  return s;
+}
+
+/* the only global reduction of the solver */
+void LowSyncGmres::sum_all(std::vector<double>& values)
+{
+  int n = values.size();
+  std::vector<double> local(values);
+  Teuchos::reduceAll<int, double>(
+      *comm, Teuchos::REDUCE_SUM, n, &local[0], &values[0]);
+  num_reductions++;
+}
+
+void LowSyncGmres::apply_op(Vector const& v, Vector& w)
+{
+  P->apply(v, *z);
+  A->apply(*z, w);
+}
+
+/* rotates column k of the hessenberg matrix into R and returns the
+   norm of the updated residual */
+double LowSyncGmres::rotate(unsigned k)
+{
+  for (unsigned i=0; i <= k+1; ++i)
+    r(i,k) = h(i,k);
+  for (unsigned i=0; i < k; ++i) {
+    double t = cs[i]*r(i,k) + sn[i]*r(i+1,k);
+    r(i+1,k) = -sn[i]*r(i,k) + cs[i]*r(i+1,k);
+    r(i,k) = t;
+  }
+  double d = std::sqrt(r(k,k)*r(k,k) + r(k+1,k)*r(k+1,k));
+  cs[k] = r(k,k)/d;
+  sn[k] = r(k+1,k)/d;
+  r(k,k) = d;
+  r(k+1,k) = 0.0;
+  g[k+1] = -sn[k]*g[k];
+  g[k] = cs[k]*g[k];
+  return std::abs(g[k+1]);
+}
+
+void LowSyncGmres::update_solution(unsigned k, Vector& x)
+{
+  std::vector<double> y(k);
+  for (unsigned i=k; i-- > 0;) {
+    y[i] = g[i];
+    for (unsigned j=i+1; j < k; ++j)
+      y[i] -= r(i,j)*y[j];
+    y[i] /= r(i,i);
+  }
+  Vector s(x.getMap());
+  for (unsigned i=0; i < k; ++i)
+    s.update(y[i], *(V->getVector(i)), 1.0);
+  P->apply(s, *z);
+  x.update(1.0, *z, 1.0);
+}
+
+/* one restart cycle, returns the number of finished basis vectors */
+unsigned LowSyncGmres::cycle_icgs(Vector const& res)
+{
+  std::vector<double> s(1, local_dot(res, res));
+  sum_all(s);
+  double beta = std::sqrt(s[0]);
+  if (scale == 0.0) scale = beta;
+  if ((beta <= tol*scale) || (iters >= max_iters)) {
+    done = true;
+    return 0;
+  }
+  V->getVectorNonConst(0)->update(1.0/beta, res, 0.0);
+  g[0] = beta;
+  Vector w(res.getMap());
+  for (unsigned j=0; j < krylov; ++j) {
+    apply_op(*(V->getVector(j)), w);
+    for (unsigned pass=0; pass < 2; ++pass) {
+      std::vector<double> c(j+1);
+      for (unsigned i=0; i <= j; ++i)
+        c[i] = local_dot(*(V->getVector(i)), w);
+      sum_all(c);
+      for (unsigned i=0; i <= j; ++i) {
+        h(i,j) += c[i];
+        w.update(-c[i], *(V->getVector(i)), 1.0);
+      }
+    }
+    std::vector<double> n(1, local_dot(w, w));
+    sum_all(n);
+    double rho = std::sqrt(n[0]);
+    h(j+1,j) = rho;
+    double norm = rotate(j);
+    iters++;
+    if ((norm <= tol*scale) || (rho == 0.0) || (iters >= max_iters)) {
+      done = true;
+      return j+1;
+    }
+    V->getVectorNonConst(j+1)->update(1.0/rho, w, 0.0);
+  }
+  return krylov;
+}
+
+/* one restart cycle, returns the number of finished basis vectors.
+   column j of V holds the candidate u for basis vector j, projected
+   once, and w = B u. the reduction [V_0..V_j-1, u]^T [u, w] gives
+   the second projection a and the norm of u, which finish V_j and
+   column j-1 of H, and the first projection of w. since
+   B V_j = (w - B V_0..j-1 a)/rho and the finished columns satisfy
+   B V_0..j-1 = V_0..j H, w needs no second application of B. */
+unsigned LowSyncGmres::cycle_dcgs2(Vector const& res)
+{
+  RCP<Vector> u = V->getVectorNonConst(0);
+  Vector w(res.getMap());
+  u->assign(res);
+  apply_op(*u, w);
+  for (unsigned j=0; ; ++j) {
+    u = V->getVectorNonConst(j);
+    std::vector<double> s(2*(j+1));
+    for (unsigned i=0; i < j; ++i) {
+      RCP<const Vector> vi = V->getVector(i);
+      s[2*i] = local_dot(*vi, *u);
+      s[2*i+1] = local_dot(*vi, w);
+    }
+    s[2*j] = local_dot(*u, *u);
+    s[2*j+1] = local_dot(*u, w);
+    sum_all(s);
+    double aa = 0.0;
+    double ab = 0.0;
+    for (unsigned i=0; i < j; ++i) {
+      aa += s[2*i]*s[2*i];
+      ab += s[2*i]*s[2*i+1];
+    }
+    double rho = std::sqrt(std::max(s[2*j] - aa, 0.0));
+    if (j == 0) {
+      g[0] = rho;
+      if (scale == 0.0) scale = rho;
+      if ((rho <= tol*scale) || (iters >= max_iters)) {
+        done = true;
+        return 0;
+      }
+    }
+    else {
+      for (unsigned i=0; i < j; ++i)
+        h(i,j-1) += s[2*i];
+      h(j,j-1) = rho;
+      double norm = rotate(j-1);
+      iters++;
+      if ((norm <= tol*scale) || (rho == 0.0) || (iters >= max_iters)) {
+        done = true;
+        return j;
+      }
+      if (j == krylov)
+        return krylov;
+    }
+    for (unsigned i=0; i < j; ++i)
+      u->update(-s[2*i], *(V->getVector(i)), 1.0);
+    u->scale(1.0/rho);
+    std::vector<double> ha(j+1, 0.0);
+    for (unsigned i=0; i <= j; ++i)
+    for (unsigned l=0; l < j; ++l)
+      ha[i] += h(i,l)*s[2*l];
+    for (unsigned i=0; i <= j; ++i)
+      w.update(-ha[i], *(V->getVector(i)), 1.0);
+    w.scale(1.0/rho);
+    for (unsigned i=0; i <= j; ++i) {
+      double c = (i < j) ? s[2*i+1] : (s[2*j+1] - ab)/rho;
+      h(i,j) = (c - ha[i])/rho;
+      w.update(-h(i,j), *(V->getVector(i)), 1.0);
+    }
+    V->getVectorNonConst(j+1)->assign(w);
+    if ((j+1 < krylov) && (iters+1 < max_iters))
+      apply_op(*(V->getVector(j+1)), w);
+    else
+      w.putScalar(0.0);
+  }
+}
+
+void LowSyncGmres::solve_vector(
+    Vector& x,
+    Vector const& b,
+    bool rhs_scaling)
+{
+  iters = 0;
+  scale = 0.0;
+  done = false;
+  if (rhs_scaling) {
+    std::vector<double> s(1, local_dot(b, b));
+    sum_all(s);
+    scale = std::sqrt(s[0]);
+  }
+  Vector res(x.getMap());
+  while (! done) {
+    A->apply(x, res);
+    res.update(1.0, b, -1.0);
+    H.assign((krylov+1)*krylov, 0.0);
+    R.assign((krylov+1)*krylov, 0.0);
+    cs.assign(krylov, 0.0);
+    sn.assign(krylov, 0.0);
+    g.assign(krylov+1, 0.0);
+    unsigned k = (ortho == "icgs") ? cycle_icgs(res) : cycle_dcgs2(res);
+    if (k > 0)
+      update_solution(k, x);
+  }
+  num_iters = std::max(num_iters, iters);
+}
+
+void LowSyncGmres::solve(
+    RCP<Operator> op,
+    RCP<Operator> prec,
+    RCP<MultiVector> x,
+    RCP<const MultiVector> b,
+    double tolerance,
+    bool rhs_scaling)
+{
+  A = op;
+  P = prec;
+  tol = tolerance;
+  comm = x->getMap()->getComm();
+  V = rcp(new MultiVector(x->getMap(), krylov+1));
+  z = rcp(new Vector(x->getMap()));
+  num_iters = 0;
+  num_reductions = 0;
+  for (size_t i=0; i < x->getNumVectors(); ++i)
+    solve_vector(*(x->getVectorNonConst(i)), *(b->getVector(i)), rhs_scaling);
+  A = Teuchos::null;
+  P = Teuchos::null;
+  V = Teuchos::null;
+  z = Teuchos::null;
+}
+
+}
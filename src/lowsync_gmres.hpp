@@ -0,0 +1,83 @@
+#ifndef goal_lowsync_gmres_hpp
+#define goal_lowsync_gmres_hpp
+
+#include "data_types.hpp"
+
+#include <vector>
+
+namespace goal {
+
+using Teuchos::rcp;
+using Teuchos::RCP;
+
+/* restarted, right preconditioned gmres with classical gram-schmidt
+   orthogonalization that makes its own global reductions, so they
+   can be counted as they happen. icgs projects each new basis vector
+   twice and then normalizes it, three reductions per iteration.
+   dcgs2 delays the second projection and the normalization of a
+   basis vector to the next iteration, where their inner products
+   share one reduction with the first projection of the next vector. */
+
+class LowSyncGmres
+{
+  public:
+
+    LowSyncGmres(
+        std::string const& ortho,
+        unsigned krylov_size,
+        unsigned max_iters);
+
+    void solve(
+        RCP<Operator> A,
+        RCP<Operator> P,
+        RCP<MultiVector> x,
+        RCP<const MultiVector> b,
+        double tolerance,
+        bool rhs_scaling);
+
+    unsigned get_num_iters() {return num_iters;}
+
+    unsigned get_num_reductions() {return num_reductions;}
+
+  private:
+
+    std::string ortho;
+    unsigned krylov;
+    unsigned max_iters;
+
+    unsigned num_iters;
+    unsigned num_reductions;
+
+    RCP<const Comm> comm;
+    RCP<Operator> A;
+    RCP<Operator> P;
+    RCP<MultiVector> V;
+    RCP<Vector> z;
+
+    unsigned iters;
+    double tol;
+    double scale;
+    bool done;
+
+    std::vector<double> H;
+    std::vector<double> R;
+    std::vector<double> cs;
+    std::vector<double> sn;
+    std::vector<double> g;
+
+    double& h(unsigned i, unsigned j) {return H[i + j*(krylov+1)];}
+    double& r(unsigned i, unsigned j) {return R[i + j*(krylov+1)];}
+
+    void sum_all(std::vector<double>& values);
+    void apply_op(Vector const& v, Vector& w);
+    double rotate(unsigned k);
+    void update_solution(unsigned k, Vector& x);
+    unsigned cycle_icgs(Vector const& res);
+    unsigned cycle_dcgs2(Vector const& res);
+    void solve_vector(Vector& x, Vector const& b, bool rhs_scaling);
+
+};
+
+}
+
+#endif
@@ -12,6 +12,9 @@ static RCP<ParameterList> get_valid_params(RCP<Mesh> m)
   Teuchos::Array<std::string> dummy(0);
   p->set<std::string>("model", "");
   p->set<bool>("mixed formulation", false);
+  p->set<bool>("linear problem", false);
+  p->set<bool>("symmetric dirichlet", false);
+  p->set<bool>("fused kernel", false);
   p->sublist("dirichlet bcs");
   p->sublist("neumann bcs");
   p->sublist("temperature");
@@ -48,6 +51,12 @@ void Mechanics::validate_params()
     bf = params->get<Teuchos::Array<std::string> >("body force");
     CHECK(bf.size() == mesh->get_num_dims());
   }
+  if (fused_kernel) {
+    if (model != "linear elastic")
+      fail("fused kernel requires the linear elastic model");
+    if (have_pressure_eq || enable_dynamics || have_body_force)
+      fail("fused kernel does not support mixed, dynamic or body force");
+  }
   params->validateParameters(*get_valid_params(mesh), 0);
 }
 
@@ -61,7 +70,10 @@ Mechanics::Mechanics(
   have_pressure_eq(false),
   have_temperature(false),
   have_body_force(false),
-  small_strain(false)
+  small_strain(false),
+  linear(false),
+  symmetric_dirichlet(false),
+  fused_kernel(false)
 {
   setup_params();
   validate_params();
@@ -82,20 +94,20 @@ void Mechanics::build_primal()
   double t0 = time();
   set_primal();
   typedef GoalTraits::Forward F;
-  typedef GoalTraits::Derivative D;
+  unsigned num_dofs = mesh->get_num_elem_dofs();
   vfms.resize(mesh->get_num_elem_sets());
   for (unsigned i=0; i < mesh->get_num_elem_sets(); ++i) {
     vfms[i] = rcp(new PHX::FieldManager<GoalTraits>);
     std::string const& set = mesh->get_elem_set_name(i);
     register_volumetric<F>(set, vfms[i]);
-    register_volumetric<D>(set, vfms[i]);
+    GOAL_DISPATCH_DERIVATIVE(num_dofs, register_volumetric, set, vfms[i]);
   }
   nfm = rcp(new PHX::FieldManager<GoalTraits>);
   dfm = rcp(new PHX::FieldManager<GoalTraits>);
   register_neumann<F>(nfm);
-  register_neumann<D>(nfm);
+  GOAL_DISPATCH_DERIVATIVE(num_dofs, register_neumann, nfm);
   register_dirichlet<F>(dfm);
-  register_dirichlet<D>(dfm);
+  GOAL_DISPATCH_DERIVATIVE(num_dofs, register_dirichlet, dfm);
   double t1 = time();
   print("primal pde fields built in %f seconds", t1-t0);
 }
@@ -104,19 +116,38 @@ void Mechanics::build_dual()
 {
   double t0 = time();
   set_dual();
-  typedef GoalTraits::Derivative D;
+  unsigned num_dofs = mesh->get_num_elem_dofs();
   vfms.resize(mesh->get_num_elem_sets());
   for (unsigned i=0; i < mesh->get_num_elem_sets(); ++i) {
     vfms[i] = rcp(new PHX::FieldManager<GoalTraits>);
     std::string const& set = mesh->get_elem_set_name(i);
-    register_volumetric<D>(set, vfms[i]);
+    GOAL_DISPATCH_DERIVATIVE(num_dofs, register_volumetric, set, vfms[i]);
   }
   dfm = rcp(new PHX::FieldManager<GoalTraits>);
-  register_dirichlet<D>(dfm);
+  GOAL_DISPATCH_DERIVATIVE(num_dofs, register_dirichlet, dfm);
   double t1 = time();
   print("dual pde fields built in %f seconds", t1-t0);
 }
 
+/* only the qoi derivative is assembled, for a dual problem that
+   reuses the transpose of the primal jacobian. */
+void Mechanics::build_qoi()
+{
+  double t0 = time();
+  set_qoi();
+  unsigned num_dofs = mesh->get_num_elem_dofs();
+  vfms.resize(mesh->get_num_elem_sets());
+  for (unsigned i=0; i < mesh->get_num_elem_sets(); ++i) {
+    vfms[i] = rcp(new PHX::FieldManager<GoalTraits>);
+    std::string const& set = mesh->get_elem_set_name(i);
+    GOAL_DISPATCH_DERIVATIVE(num_dofs, register_volumetric, set, vfms[i]);
+  }
+  dfm = rcp(new PHX::FieldManager<GoalTraits>);
+  GOAL_DISPATCH_DERIVATIVE(num_dofs, register_dirichlet, dfm);
+  double t1 = time();
+  print("qoi fields built in %f seconds", t1-t0);
+}
+
 void Mechanics::build_error()
 {
   double t0 = time();
@@ -165,6 +196,7 @@ void Mechanics::set_primal()
   is_primal = true;
   is_dual = false;
   is_error = false;
+  is_qoi = false;
 }
 
 void Mechanics::set_dual()
@@ -172,6 +204,7 @@ void Mechanics::set_dual()
   is_primal = false;
   is_dual = true;
   is_error = false;
+  is_qoi = false;
 }
 
 void Mechanics::set_error()
@@ -179,6 +212,15 @@ void Mechanics::set_error()
   is_primal = false;
   is_dual = false;
   is_error = true;
+  is_qoi = false;
+}
+
+void Mechanics::set_qoi()
+{
+  is_primal = false;
+  is_dual = false;
+  is_error = false;
+  is_qoi = true;
 }
 
 void Mechanics::setup_params()
@@ -190,6 +232,27 @@ void Mechanics::setup_params()
     have_temperature = true;
   if (params->isParameter("body force"))
     have_body_force = true;
+  /* temperature and body forces only enter the residual, so the
+     jacobian of the small strain elastic model is constant */
+  linear = (model == "linear elastic");
+  if (params->isParameter("linear problem"))
+    linear = params->get<bool>("linear problem");
+  if (params->isParameter("symmetric dirichlet"))
+    symmetric_dirichlet = params->get<bool>("symmetric dirichlet");
+  if (params->isParameter("fused kernel"))
+    fused_kernel = params->get<bool>("fused kernel");
+  /* each qoi gets its own dual solution, solved as one block */
+  if (params->isSublist("qoi")) {
+    ParameterList const& qp = params->sublist("qoi");
+    if (qp.isParameter("names"))
+      qoi_names = qp.get<Teuchos::Array<std::string> >("names");
+    else if (qp.isParameter("name"))
+      qoi_names.push_back(qp.get<std::string>("name"));
+    for (unsigned i=0; i < qoi_names.size(); ++i)
+    for (unsigned j=0; j < i; ++j)
+      if (qoi_names[i] == qoi_names[j])
+        fail("repeated qoi: %s", qoi_names[i].c_str());
+  }
 }
 
 void Mechanics::setup_variables()
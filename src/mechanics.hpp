@@ -27,9 +27,14 @@ class Mechanics
         bool enable_dynamics);
 
     unsigned get_num_eqs();
-    
+    bool is_mixed() {return have_pressure_eq;}
+    bool is_linear() {return linear;}
+    bool is_symmetric_dirichlet() {return symmetric_dirichlet;}
+    unsigned get_num_qois() {return qoi_names.size();}
+
     void build_primal();
     void build_dual();
+    void build_qoi();
     void build_error();
 
     void project_state();
@@ -53,14 +58,19 @@ class Mechanics
     bool have_temperature;
     bool have_body_force;
     bool small_strain;
+    bool linear;
+    bool symmetric_dirichlet;
+    bool fused_kernel;
 
     bool is_primal;
     bool is_dual;
     bool is_error;
+    bool is_qoi;
 
     unsigned num_eqs;
 
     Teuchos::Array<std::string> var_names[3];
+    Teuchos::Array<std::string> qoi_names;
     std::map<std::string, unsigned> offsets;
     std::map<std::string, Teuchos::Array<std::string> > fields;
 
@@ -76,6 +86,7 @@ class Mechanics
     void set_primal();
     void set_dual();
     void set_error();
+    void set_qoi();
 
     void setup_params();
     void setup_variables();
@@ -90,6 +101,7 @@ class Mechanics
         std::string const& set,
         RCP<const ParameterList> material_params,
         RCP<const ParameterList> temperature_params,
+        bool tangent,
         FieldManager fm);
 
     template <typename EvalT>
@@ -41,5 +41,7 @@ void goal::Mechanics::register_dirichlet(FieldManager fm)
 template void goal::Mechanics::
 register_dirichlet<goal::GoalTraits::Forward>(FieldManager fm);
 
-template void goal::Mechanics::
-register_dirichlet<goal::GoalTraits::Derivative>(FieldManager fm);
+#define GOAL_DIRICHLET_ETI(EvalT) \
+template void goal::Mechanics::register_dirichlet<EvalT>(FieldManager fm);
+
+GOAL_FOR_EACH_DERIVATIVE(GOAL_DIRICHLET_ETI)
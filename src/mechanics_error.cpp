@@ -55,6 +55,8 @@ template void goal::Mechanics::
 register_error<goal::GoalTraits::Forward>(
     std::string const& set, FieldManager fm);
 
-template void goal::Mechanics::
-register_error<goal::GoalTraits::Derivative>(
+#define GOAL_ERROR_ETI(EvalT) \
+template void goal::Mechanics::register_error<EvalT>( \
     std::string const& set, FieldManager fm);
+
+GOAL_FOR_EACH_DERIVATIVE(GOAL_ERROR_ETI)
@@ -9,11 +9,20 @@
 #include "ev_model_j2.hpp"
 #include "ev_model_creep.hpp"
 
+/* the fields of a model evaluated in analytic tangent mode */
+static void set_tangent_names(Teuchos::RCP<Teuchos::ParameterList> p)
+{
+  p->set<std::string>("BF Name", "BF");
+  p->set<std::string>("First PK Name", "first_pk_val");
+  p->set<std::string>("First PK Tangent Name", "first_pk_tangent");
+}
+
 template <typename EvalT>
 void goal::Mechanics::register_model(
     std::string const& set,
     RCP<const ParameterList> material_params,
     RCP<const ParameterList> temperature_params,
+    bool tangent,
     FieldManager fm)
 {
   /* do some work to create a data layout */
@@ -35,6 +44,8 @@ void goal::Mechanics::register_model(
     p->set<RCP<const ParameterList> >("Temperature Params",temperature_params);
     p->set<Teuchos::Array<std::string> >("Disp Names", fields["disp"]);
     p->set<std::string>("Cauchy Name", "cauchy");
+    if (tangent)
+      set_tangent_names(p);
     ev = rcp(new ModelElastic<EvalT, GoalTraits>(*p));
     fm->template registerEvaluator<EvalT>(ev);
   }
@@ -48,11 +59,17 @@ void goal::Mechanics::register_model(
     p->set<std::string>("Def Grad Name", "F");
     p->set<std::string>("Det Def Grad Name", "J");
     p->set<std::string>("Cauchy Name", "cauchy");
+    if (tangent) {
+      p->set<Teuchos::Array<std::string> >("Disp Names", fields["disp"]);
+      set_tangent_names(p);
+    }
     ev = rcp(new ModelJ2<EvalT, GoalTraits>(*p));
     fm->template registerEvaluator<EvalT>(ev);
   }
 
   else if (model == "creep") { /* creep model */
+    if (tangent)
+      fail("creep model has no analytic tangent");
     RCP<ParameterList> p = rcp(new ParameterList);
     p->set<RCP<Layouts> >("Layouts", dl);
     p->set<RCP<StateFields> >("State Fields", state_fields);
@@ -75,11 +92,15 @@ register_model<goal::GoalTraits::Forward>(
     std::string const& set,
     RCP<const ParameterList> material_params,
     RCP<const ParameterList> temperature_params,
+    bool tangent,
     FieldManager fm);
 
-template void goal::Mechanics::
-register_model<goal::GoalTraits::Derivative>(
-    std::string const& set,
-    RCP<const ParameterList> material_params,
-    RCP<const ParameterList> temperature_params,
+#define GOAL_MODEL_ETI(EvalT) \
+template void goal::Mechanics::register_model<EvalT>( \
+    std::string const& set, \
+    RCP<const ParameterList> material_params, \
+    RCP<const ParameterList> temperature_params, \
+    bool tangent, \
     FieldManager fm);
+
+GOAL_FOR_EACH_DERIVATIVE(GOAL_MODEL_ETI)
@@ -50,5 +50,7 @@ void goal::Mechanics::register_neumann(FieldManager fm)
 template void goal::Mechanics::
 register_neumann<goal::GoalTraits::Forward>(FieldManager fm);
 
-template void goal::Mechanics::
-register_neumann<goal::GoalTraits::Derivative>(FieldManager fm);
+#define GOAL_NEUMANN_ETI(EvalT) \
+template void goal::Mechanics::register_neumann<EvalT>(FieldManager fm);
+
+GOAL_FOR_EACH_DERIVATIVE(GOAL_NEUMANN_ETI)
@@ -8,29 +8,33 @@
 #include "ev_qoi_avg_displacement.hpp"
 #include "ev_scatter_qoi.hpp"
 
+namespace goal {
+
 template <typename EvalT>
-void goal::Mechanics::register_qoi(
-    std::string const& set, FieldManager fm)
+static void register_qoi_index(
+    std::string const& qoi_name,
+    unsigned index,
+    RCP<Layouts> dl,
+    RCP<Mesh> mesh,
+    Teuchos::Array<std::string> const& disp_names,
+    FieldManager fm)
 {
-  /* do some work to create a data layout */
-  unsigned ws_size = mesh->get_ws_size();
-  unsigned n_nodes = mesh->get_num_elem_nodes();
-  unsigned n_qps = mesh->get_num_elem_qps();
-  unsigned n_dims = mesh->get_num_dims();
-  RCP<Layouts> dl = rcp(new Layouts(ws_size, n_nodes, n_qps, n_dims));
-
   /* temporary variable */
   RCP<PHX::Evaluator<GoalTraits> > ev;
 
-  /* get the quantity of interest parameters */
-  assert_sublist(params, "qoi");
-  RCP<const ParameterList> qoi_params = rcpFromRef(params->sublist("qoi"));
-  std::string qoi_name = qoi_params->get<std::string>("name");
+  /* the average of one displacement component */
+  int component = -1;
+  unsigned n_dims = dl->node_qp_vector->dimension(3);
+  std::string const components[3] = {"x", "y", "z"};
+  for (unsigned i=0; i < n_dims; ++i)
+    if (qoi_name == "avg displacement " + components[i])
+      component = i;
 
-  if (qoi_name == "avg displacement") {
+  if ((qoi_name == "avg displacement") || (component >= 0)) {
     RCP<ParameterList> p = rcp(new ParameterList);
     p->set<RCP<Layouts> >("Layouts", dl);
-    p->set<Teuchos::Array<std::string> >("Disp Names", fields["disp"]);
+    p->set<int>("Component", component);
+    p->set<Teuchos::Array<std::string> >("Disp Names", disp_names);
     p->set<std::string>("Weighted Dv Name", "wDv");
     p->set<std::string>("Avg Displacement Name", qoi_name);
     ev = rcp(new QoIAvgDisplacement<EvalT, GoalTraits>(*p));
@@ -40,16 +44,40 @@ void goal::Mechanics::register_qoi(
   else
     fail("unknown qoi name: %s", qoi_name.c_str());
 
-  { /* scatter qoi */
+  { /* scatter qoi into its column of the qoi vectors */
     RCP<ParameterList> p = rcp(new ParameterList);
     p->set<RCP<Layouts> >("Layouts", dl);
     p->set<RCP<Mesh> >("Mesh", mesh);
     p->set<std::string>("QoI Name", qoi_name);
+    p->set<unsigned>("QoI Index", index);
     ev = rcp(new ScatterQoI<EvalT, GoalTraits>(*p));
     fm->template registerEvaluator<EvalT>(ev);
-    PHX::Tag<typename EvalT::ScalarT> tag("Scatter QoI", dl->dummy);
+    std::string name = "Scatter QoI: " + qoi_name;
+    PHX::Tag<typename EvalT::ScalarT> tag(name, dl->dummy);
     fm->requireField<EvalT>(tag);
   }
+}
+
+}
+
+template <typename EvalT>
+void goal::Mechanics::register_qoi(
+    std::string const& set, FieldManager fm)
+{
+  /* do some work to create a data layout */
+  unsigned ws_size = mesh->get_ws_size();
+  unsigned n_nodes = mesh->get_num_elem_nodes();
+  unsigned n_qps = mesh->get_num_elem_qps();
+  unsigned n_dims = mesh->get_num_dims();
+  RCP<Layouts> dl = rcp(new Layouts(ws_size, n_nodes, n_qps, n_dims));
+
+  /* get the quantity of interest parameters */
+  assert_sublist(params, "qoi");
+  if (qoi_names.size() == 0)
+    fail("qoi sublist requires a name or a list of names");
+
+  for (unsigned i=0; i < qoi_names.size(); ++i)
+    register_qoi_index<EvalT>(qoi_names[i], i, dl, mesh, fields["disp"], fm);
 
 }
 
@@ -58,6 +86,8 @@ template void goal::Mechanics::
 register_qoi<goal::GoalTraits::Forward>(
     std::string const& set, FieldManager fm);
 
-template void goal::Mechanics::
-register_qoi<goal::GoalTraits::Derivative>(
+#define GOAL_QOI_ETI(EvalT) \
+template void goal::Mechanics::register_qoi<EvalT>( \
     std::string const& set, FieldManager fm);
+
+GOAL_FOR_EACH_DERIVATIVE(GOAL_QOI_ETI)
@@ -12,6 +12,7 @@
 #include "ev_first_pk.hpp"
 #include "ev_elem_size.hpp"
 #include "ev_mechanics_residual.hpp"
+#include "ev_mechanics_fused.hpp"
 #include "ev_pressure_residual.hpp"
 #include "ev_scatter_residual.hpp"
 
@@ -84,14 +85,10 @@ void goal::Mechanics::register_volumetric(
     register_solutions<EvalT>(dl, mesh, var_names[2], 2, ev, fm);
   }
 
-  { /* kinematic quantities */
-    RCP<ParameterList> p = rcp(new ParameterList);
-    p->set<RCP<Layouts> >("Layouts", dl);
-    p->set<Teuchos::Array<std::string> >("Disp Names", fields["disp"]);
-    p->set<std::string>("Def Grad Name", "F");
-    p->set<std::string>("Det Def Grad Name", "J");
-    ev = rcp(new Kinematics<EvalT, GoalTraits>(*p));
-    fm->template registerEvaluator<EvalT>(ev);
+  /* the qoi needs only the interpolated solution */
+  if (is_qoi) {
+    this->template register_qoi<EvalT>(set, fm);
+    return;
   }
 
   /* material parameters */
@@ -101,9 +98,42 @@ void goal::Mechanics::register_volumetric(
   RCP<const ParameterList> tp;
   if (have_temperature) tp = rcpFromRef(params->sublist("temperature"));
 
-  this->template register_model<EvalT>(set, mp, tp, fm);
+  /* with an analytic tangent the derivative sweeps skip kinematics and
+     first pk, the model evaluates the real first pk stress and its
+     tangent, and the residual contracts them into the element jacobian */
+  bool tangent = Sacado::IsADType<typename EvalT::ScalarT>::value &&
+    mp->isParameter("analytic tangent") && mp->get<bool>("analytic tangent");
+  if (tangent && (fused_kernel || have_pressure_eq || enable_dynamics))
+    fail("analytic tangent does not support fused, mixed or dynamic");
+
+  if (fused_kernel) { /* elastic residual in one pass per element */
+    small_strain = true;
+    RCP<ParameterList> p = rcp(new ParameterList);
+    p->set<RCP<Layouts> >("Layouts", dl);
+    p->set<RCP<StateFields> >("State Fields", state_fields);
+    p->set<RCP<const ParameterList> >("Material Params", mp);
+    p->set<RCP<const ParameterList> >("Temperature Params", tp);
+    p->set<Teuchos::Array<std::string> >("Disp Names", fields["disp"]);
+    p->set<std::string>("BF Name", "BF");
+    p->set<std::string>("Weighted Dv Name", "wDv");
+    ev = rcp(new MechanicsFused<EvalT, GoalTraits>(*p));
+    fm->template registerEvaluator<EvalT>(ev);
+  }
+
+  if ((! fused_kernel) && (! tangent)) { /* kinematic quantities */
+    RCP<ParameterList> p = rcp(new ParameterList);
+    p->set<RCP<Layouts> >("Layouts", dl);
+    p->set<Teuchos::Array<std::string> >("Disp Names", fields["disp"]);
+    p->set<std::string>("Def Grad Name", "F");
+    p->set<std::string>("Det Def Grad Name", "J");
+    ev = rcp(new Kinematics<EvalT, GoalTraits>(*p));
+    fm->template registerEvaluator<EvalT>(ev);
+  }
+
+  if (! fused_kernel)
+    this->template register_model<EvalT>(set, mp, tp, tangent, fm);
 
-  { /* first piola kirchhoff stress tensor */
+  if ((! fused_kernel) && (! tangent)) { /* first piola kirchhoff stress */
     RCP<ParameterList> p = rcp(new ParameterList);
     p->set<RCP<Layouts> >("Layouts", dl);
     p->set<bool>("Small Strain", small_strain);
@@ -118,14 +148,16 @@ void goal::Mechanics::register_volumetric(
     fm->template registerEvaluator<EvalT>(ev);
   }
 
-  { /* mechanics residual */
+  if (! fused_kernel) { /* mechanics residual */
     RCP<ParameterList> p = rcp(new ParameterList);
     p->set<RCP<Layouts> >("Layouts", dl);
     p->set<RCP<Mesh> >("Mesh", mesh);
     p->set<std::string>("BF Name", "BF");
     p->set<Teuchos::Array<std::string> >("Disp Names", fields["disp"]);
     p->set<std::string>("Weighted Dv Name", "wDv");
-    p->set<std::string>("First PK Name", "first_pk");
+    p->set<std::string>("First PK Name", tangent ? "first_pk_val" : "first_pk");
+    if (tangent)
+      p->set<std::string>("First PK Tangent Name", "first_pk_tangent");
     p->set<bool>("Enable Dynamics", enable_dynamics);
     if (enable_dynamics) {
       p->set<double>("Density", mp->get<double>("rho"));
@@ -192,6 +224,8 @@ template void goal::Mechanics::
 register_volumetric<goal::GoalTraits::Forward>(
     std::string const& set, FieldManager fm);
 
-template void goal::Mechanics::
-register_volumetric<goal::GoalTraits::Derivative>(
+#define GOAL_VOLUMETRIC_ETI(EvalT) \
+template void goal::Mechanics::register_volumetric<EvalT>( \
     std::string const& set, FieldManager fm);
+
+GOAL_FOR_EACH_DERIVATIVE(GOAL_VOLUMETRIC_ETI)
@@ -8,8 +8,11 @@
 #include <apfShape.h>
 #include <apfAlbany.h>
 #include <apfNumbering.h>
+#include <apfIntegrate.h>
 #include <gmi_mesh.h>
 
+#include <cmath>
+
 namespace goal {
 
 static RCP<ParameterList> get_valid_params()
@@ -21,6 +24,7 @@ static RCP<ParameterList> get_valid_params()
   p->set<unsigned>("p order", 1);
   p->set<unsigned>("q order", 1);
   p->set<unsigned>("ws size", 0);
+  p->set<bool>("basis cache", true);
   return p;
 }
 
@@ -118,6 +122,7 @@ static unsigned get_elem_type(apf::Mesh* m)
 Mesh::Mesh(RCP<const ParameterList> p) :
   params(p),
   num_eqs(0),
+  cache_basis(true),
   mesh(0),
   shape(0),
   numbering(0)
@@ -130,6 +135,8 @@ Mesh::Mesh(RCP<const ParameterList> p) :
   ws_size = params->get<unsigned>("ws size");
   p_order = params->get<unsigned>("p order");
   q_order = params->get<unsigned>("q order");
+  if (params->isParameter("basis cache"))
+    cache_basis = params->get<bool>("basis cache");
   shape = apf::getHierarchic(p_order);
   comm = Tpetra::DefaultPlatform::getDefaultPlatform().getComm();
   print(" num element sets %u", get_num_elem_sets());
@@ -205,6 +212,24 @@ std::vector<apf::MeshEntity*> const& Mesh::get_elems(
   return elem_sets[elem_set][ws_idx];
 }
 
+/* the overlap lids of a workset, flattened as [elem][node][eq].
+   get_lid shares one scratch array, the table can be read by
+   threaded element loops. */
+std::vector<LO> const& Mesh::get_elem_lids(
+    std::string const& elem_set, const unsigned ws_idx)
+{
+  CHECK(elem_lids.count(elem_set));
+  return elem_lids[elem_set][ws_idx];
+}
+
+BasisCache const& Mesh::get_basis_cache(
+    std::string const& elem_set, const unsigned ws_idx)
+{
+  CHECK(cache_basis);
+  CHECK(basis_caches.count(elem_set));
+  return basis_caches[elem_set][ws_idx];
+}
+
 std::vector<apf::MeshEntity*> const& Mesh::get_facets(
     std::string const& facet_set)
 {
@@ -270,9 +295,24 @@ void Mesh::compute_owned_map()
       indices[get_dof(i,j,num_eqs)] = get_dof(gid,j,num_eqs);
   }
   owned_map = Tpetra::createNonContigMap<LO,GO>(indices,comm);
+  compute_vertex_map(owned);
   apf::synchronize(numbering);
 }
 
+/* with the hierarchic basis the vertex dofs are exactly the linear
+   dofs, so this is the p=1 space embedded in the current space. */
+void Mesh::compute_vertex_map(apf::DynamicArray<apf::Node>& owned)
+{
+  Teuchos::Array<GO> indices;
+  for (unsigned i=0; i < owned.getSize(); ++i) {
+    if (mesh->getType(owned[i].entity) != apf::Mesh::VERTEX) continue;
+    GO gid = apf::getNumber(numbering, owned[i]);
+    for (unsigned j=0; j < num_eqs; ++j)
+      indices.push_back(get_dof(gid,j,num_eqs));
+  }
+  vertex_map = Tpetra::createNonContigMap<LO,GO>(indices,comm);
+}
+
 void Mesh::compute_overlap_map()
 {
   apf::Numbering* overlap = apf::numberOverlapNodes(mesh,"o",shape);
@@ -354,6 +394,183 @@ void Mesh::compute_elem_sets()
   }
 }
 
+/* basis values and reference gradients at the quadrature points of
+   the reference element, tabulated once per (type, p, q order). */
+struct BasisTable
+{
+  std::vector<double> w;
+  std::vector<double> BF;
+  std::vector<apf::Vector3> gBF;
+};
+
+static bool is_affine_simplex(apf::Mesh* m, int type)
+{
+  bool simplex = (type == apf::Mesh::TRIANGLE) || (type == apf::Mesh::TET);
+  return simplex && (m->getShape()->getOrder() == 1);
+}
+
+static BasisTable tabulate_basis(
+    apf::Mesh* m,
+    apf::MeshEntity* e,
+    apf::FieldShape* shape,
+    int type,
+    unsigned q_order)
+{
+  BasisTable t;
+  apf::EntityShape* es = shape->getEntityShape(type);
+  apf::Integration const* in = apf::getIntegration(type)->getAccurate(q_order);
+  unsigned nn = es->countNodes();
+  unsigned nq = in->countPoints();
+  t.w.resize(nq);
+  t.BF.resize(nq*nn);
+  t.gBF.resize(nq*nn);
+  apf::NewArray<double> bf;
+  apf::NewArray<apf::Vector3> gbf;
+  for (unsigned qp=0; qp < nq; ++qp) {
+    apf::Vector3 const& xi = in->getPoint(qp)->param;
+    t.w[qp] = in->getPoint(qp)->weight;
+    es->getValues(m, e, xi, bf);
+    es->getLocalGradients(m, e, xi, gbf);
+    for (unsigned node=0; node < nn; ++node) {
+      t.BF[qp*nn + node] = bf[node];
+      t.gBF[qp*nn + node] = gbf[node];
+    }
+  }
+  return t;
+}
+
+/* for a straight sided simplex, J(i,j) = x_{i+1}[j] - x_0[j] with
+   the linear shape functions N_0 = 1 - sum(xi), N_{i+1} = xi_i. the
+   physical gradients are inv(J) times the reference gradients. */
+static double get_affine_map(
+    apf::Mesh* m,
+    apf::MeshEntity* e,
+    unsigned nd,
+    double inv[3][3])
+{
+  apf::MeshEntity* verts[4];
+  m->getDownward(e, 0, verts);
+  apf::Vector3 x[4];
+  for (unsigned v=0; v <= nd; ++v)
+    m->getPoint(verts[v], 0, x[v]);
+  double J[3][3];
+  for (unsigned i=0; i < nd; ++i)
+  for (unsigned j=0; j < nd; ++j)
+    J[i][j] = x[i+1][j] - x[0][j];
+  double det;
+  if (nd == 2) {
+    det = J[0][0]*J[1][1] - J[0][1]*J[1][0];
+    inv[0][0] =  J[1][1]/det; inv[0][1] = -J[0][1]/det;
+    inv[1][0] = -J[1][0]/det; inv[1][1] =  J[0][0]/det;
+  }
+  else {
+    det =
+      J[0][0]*(J[1][1]*J[2][2] - J[1][2]*J[2][1]) -
+      J[0][1]*(J[1][0]*J[2][2] - J[1][2]*J[2][0]) +
+      J[0][2]*(J[1][0]*J[2][1] - J[1][1]*J[2][0]);
+    inv[0][0] = (J[1][1]*J[2][2] - J[1][2]*J[2][1])/det;
+    inv[0][1] = (J[0][2]*J[2][1] - J[0][1]*J[2][2])/det;
+    inv[0][2] = (J[0][1]*J[1][2] - J[0][2]*J[1][1])/det;
+    inv[1][0] = (J[1][2]*J[2][0] - J[1][0]*J[2][2])/det;
+    inv[1][1] = (J[0][0]*J[2][2] - J[0][2]*J[2][0])/det;
+    inv[1][2] = (J[0][2]*J[1][0] - J[0][0]*J[1][2])/det;
+    inv[2][0] = (J[1][0]*J[2][1] - J[1][1]*J[2][0])/det;
+    inv[2][1] = (J[0][1]*J[2][0] - J[0][0]*J[2][1])/det;
+    inv[2][2] = (J[0][0]*J[1][1] - J[0][1]*J[1][0])/det;
+  }
+  return std::abs(det);
+}
+
+static void fill_affine_cache(
+    apf::Mesh* m,
+    std::vector<apf::MeshEntity*> const& elems,
+    BasisTable const& t,
+    unsigned nn,
+    unsigned nq,
+    unsigned nd,
+    BasisCache& c)
+{
+  double inv[3][3];
+  for (unsigned elem=0; elem < elems.size(); ++elem) {
+    double dv = get_affine_map(m, elems[elem], nd, inv);
+    for (unsigned qp=0; qp < nq; ++qp)
+      c.wDv[elem*nq + qp] = t.w[qp] * dv;
+    for (unsigned node=0; node < nn; ++node) {
+      for (unsigned qp=0; qp < nq; ++qp) {
+        unsigned idx = (elem*nn + node)*nq + qp;
+        apf::Vector3 const& g = t.gBF[qp*nn + node];
+        c.BF[idx] = t.BF[qp*nn + node];
+        for (unsigned dim=0; dim < nd; ++dim) {
+          double v = 0.0;
+          for (unsigned k=0; k < nd; ++k)
+            v += inv[dim][k] * g[k];
+          c.gBF[idx*nd + dim] = v;
+        }
+      }
+    }
+  }
+}
+
+/* the basis functions and weighted measures only change with the
+   mesh or the polynomial order, so they are evaluated here once per
+   update instead of on every residual and jacobian evaluation. on
+   straight sided simplices the reference values are tabulated once
+   and only the constant element jacobian is computed per element. */
+void Mesh::compute_basis_caches()
+{
+  basis_caches.clear();
+  if (! cache_basis) return;
+  unsigned nn = get_num_elem_nodes();
+  unsigned nq = get_num_elem_qps();
+  unsigned nd = num_dims;
+  apf::Vector3 p;
+  apf::NewArray<double> bf;
+  apf::NewArray<apf::Vector3> gbf;
+  bool affine = is_affine_simplex(mesh, elem_type);
+  BasisTable table;
+  if (affine) {
+    apf::MeshIterator* it = mesh->begin(num_dims);
+    apf::MeshEntity* first = mesh->iterate(it);
+    mesh->end(it);
+    if (first)
+      table = tabulate_basis(mesh, first, shape, elem_type, q_order);
+  }
+  for (unsigned i=0; i < get_num_elem_sets(); ++i) {
+    std::string const& set = get_elem_set_name(i);
+    unsigned num_ws = get_num_worksets(i);
+    std::vector<BasisCache>& caches = basis_caches[set];
+    caches.resize(num_ws);
+    for (unsigned ws=0; ws < num_ws; ++ws) {
+      std::vector<apf::MeshEntity*> const& elems = elem_sets[set][ws];
+      BasisCache& c = caches[ws];
+      c.wDv.resize(elems.size()*nq);
+      c.BF.resize(elems.size()*nn*nq);
+      c.gBF.resize(elems.size()*nn*nq*nd);
+      if (affine) {
+        fill_affine_cache(mesh, elems, table, nn, nq, nd, c);
+        continue;
+      }
+      for (unsigned elem=0; elem < elems.size(); ++elem) {
+        apf::MeshElement* me = apf::createMeshElement(mesh, elems[elem]);
+        for (unsigned qp=0; qp < nq; ++qp) {
+          apf::getIntPoint(me, q_order, qp, p);
+          double w = apf::getIntWeight(me, q_order, qp);
+          c.wDv[elem*nq + qp] = w * apf::getDV(me, p);
+          apf::getBF(shape, me, p, bf);
+          apf::getGradBF(shape, me, p, gbf);
+          for (unsigned node=0; node < nn; ++node) {
+            unsigned idx = (elem*nn + node)*nq + qp;
+            c.BF[idx] = bf[node];
+            for (unsigned dim=0; dim < nd; ++dim)
+              c.gBF[idx*nd + dim] = gbf[node][dim];
+          }
+        }
+        apf::destroyMeshElement(me);
+      }
+    }
+  }
+}
+
 void Mesh::compute_facet_sets()
 {
   unsigned nfs = sets->models[num_dims-1].size();
@@ -398,6 +615,27 @@ void Mesh::compute_node_sets()
   }
 }
 
+void Mesh::compute_elem_lids()
+{
+  elem_lids.clear();
+  unsigned nn = get_num_elem_nodes();
+  for (unsigned i=0; i < get_num_elem_sets(); ++i) {
+    std::string const& set = get_elem_set_name(i);
+    unsigned num_ws = get_num_worksets(i);
+    std::vector<std::vector<LO> >& lids = elem_lids[set];
+    lids.resize(num_ws);
+    for (unsigned ws=0; ws < num_ws; ++ws) {
+      std::vector<apf::MeshEntity*> const& elems = elem_sets[set][ws];
+      lids[ws].resize(elems.size()*nn*num_eqs);
+      for (unsigned elem=0; elem < elems.size(); ++elem)
+      for (unsigned node=0; node < nn; ++node)
+      for (unsigned eq=0; eq < num_eqs; ++eq)
+        lids[ws][(elem*nn + node)*num_eqs + eq] =
+          get_lid(elems[elem], node, eq);
+    }
+  }
+}
+
 void Mesh::change_p(int add)
 {
   CHECK((add==1)||(add==-1));
@@ -416,6 +654,8 @@ void Mesh::update()
   compute_elem_sets();
   compute_facet_sets();
   compute_node_sets();
+  compute_basis_caches();
+  compute_elem_lids();
   double t1 = time();
   print("mesh updated in %f seconds", t1-t0);
 }
@@ -25,6 +25,15 @@ namespace goal {
 using Teuchos::RCP;
 using Teuchos::ParameterList;
 
+/* basis data of one workset, flattened as [elem][qp] for wDv,
+   [elem][node][qp] for BF and [elem][node][qp][dim] for gBF. */
+struct BasisCache
+{
+  std::vector<double> wDv;
+  std::vector<double> BF;
+  std::vector<double> gBF;
+};
+
 class Mesh
 {
   public:
@@ -41,6 +50,7 @@ class Mesh
 
     RCP<const Map> get_owned_map() {return owned_map;}
     RCP<const Map> get_overlap_map() {return overlap_map;}
+    RCP<const Map> get_vertex_map() {return vertex_map;}
     RCP<const Graph> get_owned_graph() {return owned_graph;}
     RCP<const Graph> get_overlap_graph() {return overlap_graph;}
 
@@ -73,8 +83,15 @@ class Mesh
     LO get_lid(apf::MeshEntity* e, const unsigned n, const unsigned eq);
     LO get_lid(apf::Node* n, const unsigned eq);
 
+    std::vector<LO> const& get_elem_lids(
+        std::string const& elem_set, const unsigned ws_idx);
+
     double get_mesh_size(apf::MeshEntity* e);
 
+    bool has_basis_cache() {return cache_basis;}
+    BasisCache const& get_basis_cache(
+        std::string const& elem_set, const unsigned ws_idx);
+
     void change_p(int add);
     void update();
 
@@ -89,6 +106,8 @@ class Mesh
 
     unsigned num_eqs;
 
+    bool cache_basis;
+
     apf::Mesh2* mesh;
     apf::StkModels* sets;
     apf::FieldShape* shape;
@@ -99,20 +118,26 @@ class Mesh
     RCP<const Comm> comm;
     RCP<const Map> owned_map;
     RCP<const Map> overlap_map;
+    RCP<const Map> vertex_map;
     RCP<Graph> owned_graph;
     RCP<Graph> overlap_graph;
 
     std::map<std::string, std::vector<std::vector<apf::MeshEntity*> > > elem_sets;
     std::map<std::string, std::vector<apf::MeshEntity*> > facet_sets;
     std::map<std::string, std::vector<apf::Node*> > node_sets;
+    std::map<std::string, std::vector<BasisCache> > basis_caches;
+    std::map<std::string, std::vector<std::vector<LO> > > elem_lids;
 
     void compute_owned_map();
+    void compute_vertex_map(apf::DynamicArray<apf::Node>& owned);
     void compute_overlap_map();
     void compute_graphs();
 
     void compute_elem_sets();
     void compute_facet_sets();
     void compute_node_sets();
+    void compute_basis_caches();
+    void compute_elem_lids();
 
 };
 
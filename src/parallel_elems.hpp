@@ -0,0 +1,28 @@
+#ifndef goal_parallel_elems_hpp
+#define goal_parallel_elems_hpp
+
+#include <Kokkos_Core.hpp>
+#include <Phalanx_KokkosDeviceTypes.hpp>
+
+namespace goal {
+
+/* runs body(elem) for each element of a workset on the phalanx
+   execution space, threaded when kokkos is built with an openmp
+   or pthreads host backend. the body may only write the fields
+   of its own element, and add into shared data atomically. */
+template <typename Body>
+void parallel_elems(unsigned ws_size, Body const& body)
+{
+  Kokkos::parallel_for(
+      Kokkos::RangePolicy<PHX::Device>(0, ws_size), body);
+}
+
+/* the number of threads parallel_elems runs on */
+inline unsigned get_num_elem_threads()
+{
+  return PHX::Device::execution_space::concurrency();
+}
+
+}
+
+#endif
@@ -0,0 +1,131 @@
+#include "pmg_preconditioner.hpp"
+#include "control.hpp"
+
+#include <Ifpack2_Factory.hpp>
+#include <TpetraExt_MatrixMatrix.hpp>
+
+#ifdef GOAL_ENABLE_DIRECT
+#include <Amesos2.hpp>
+#endif
+
+namespace goal {
+
+typedef Tpetra::RowMatrix<ST, LO, GO, KNode> RM;
+typedef Ifpack2::Preconditioner<ST, LO, GO, KNode> IfpackPrec;
+
+static RCP<Matrix> build_prolongation(
+    RCP<const Map> fine_map,
+    RCP<const Map> coarse_map)
+{
+  RCP<Matrix> P = rcp(new Matrix(fine_map, 1));
+  Teuchos::ArrayView<const GO> gids = coarse_map->getNodeElementList();
+  Teuchos::Array<ST> one(1, 1.0);
+  for (unsigned i=0; i < gids.size(); ++i) {
+    CHECK(fine_map->isNodeGlobalElement(gids[i]));
+    P->insertGlobalValues(gids[i], gids(i,1), one());
+  }
+  P->fillComplete(coarse_map, fine_map);
+  return P;
+}
+
+static RCP<Matrix> build_coarse_operator(
+    RCP<Matrix> A,
+    RCP<Matrix> P)
+{
+  RCP<Matrix> AP = rcp(new Matrix(A->getRowMap(), 0));
+  Tpetra::MatrixMatrix::Multiply(*A, false, *P, false, *AP);
+  RCP<Matrix> PtAP = rcp(new Matrix(P->getDomainMap(), 0));
+  Tpetra::MatrixMatrix::Multiply(*P, true, *AP, false, *PtAP);
+  return PtAP;
+}
+
+static RCP<Operator> build_ilut(
+    RCP<Matrix> A,
+    RCP<const ParameterList> p)
+{
+  Ifpack2::Factory factory;
+  RCP<IfpackPrec> prec = factory.create<RM>("ILUT", A);
+  prec->setParameters(*p);
+  prec->initialize();
+  prec->compute();
+  return prec;
+}
+
+PMultigridPreconditioner::PMultigridPreconditioner(
+    RCP<Matrix> A,
+    RCP<const Map> coarse_map,
+    RCP<const ParameterList> p)
+{
+  double t0 = time();
+  fine = A;
+  prolongation = build_prolongation(A->getRowMap(), coarse_map);
+  coarse = build_coarse_operator(A, prolongation);
+  smoother = build_ilut(A, p);
+#ifdef GOAL_ENABLE_DIRECT
+  coarse_direct = Amesos2::create<Matrix, MultiVector>("KLU2", coarse);
+  coarse_direct->symbolicFactorization();
+  coarse_direct->numericFactorization();
+#else
+  coarse_inverse = build_ilut(coarse, p);
+#endif
+  double t1 = time();
+  print("  p-multigrid hierarchy built in %f seconds", t1-t0);
+  print("  p-multigrid coarse dofs: %lu of %lu",
+      coarse->getGlobalNumRows(), A->getGlobalNumRows());
+}
+
+RCP<const Map> PMultigridPreconditioner::getDomainMap() const
+{
+  return fine->getDomainMap();
+}
+
+RCP<const Map> PMultigridPreconditioner::getRangeMap() const
+{
+  return fine->getRangeMap();
+}
+
+void PMultigridPreconditioner::coarse_solve(
+    MultiVector const& R,
+    MultiVector& E) const
+{
+#ifdef GOAL_ENABLE_DIRECT
+  coarse_direct->solve(
+      Teuchos::ptr<MultiVector>(&E),
+      Teuchos::ptr<const MultiVector>(&R));
+#else
+  coarse_inverse->apply(R, E);
+#endif
+}
+
+/* z = S x
+   z = z + P inv(Ac) P^T (x - A z)
+   z = z + S (x - A z) */
+void PMultigridPreconditioner::apply(
+    MultiVector const& X,
+    MultiVector& Y,
+    Teuchos::ETransp mode,
+    ST alpha,
+    ST beta) const
+{
+  CHECK(mode == Teuchos::NO_TRANS);
+  size_t nv = X.getNumVectors();
+  RCP<const Map> coarse_map = coarse->getRowMap();
+  MultiVector Z(fine->getRowMap(), nv);
+  MultiVector R(fine->getRowMap(), nv);
+  MultiVector E(fine->getRowMap(), nv);
+  MultiVector Rc(coarse_map, nv);
+  MultiVector Ec(coarse_map, nv);
+  smoother->apply(X, Z);
+  R.assign(X);
+  fine->apply(Z, R, Teuchos::NO_TRANS, -1.0, 1.0);
+  prolongation->apply(R, Rc, Teuchos::TRANS);
+  coarse_solve(Rc, Ec);
+  prolongation->apply(Ec, Z, Teuchos::NO_TRANS, 1.0, 1.0);
+  R.assign(X);
+  fine->apply(Z, R, Teuchos::NO_TRANS, -1.0, 1.0);
+  smoother->apply(R, E);
+  Z.update(1.0, E, 1.0);
+  Y.update(alpha, Z, beta);
+}
+
+}
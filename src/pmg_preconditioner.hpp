@@ -0,0 +1,57 @@
+#ifndef goal_pmg_preconditioner_hpp
+#define goal_pmg_preconditioner_hpp
+
+#include "data_types.hpp"
+
+namespace Amesos2 {
+template <class Matrix, class Vector> class Solver;
+}
+
+namespace goal {
+
+using Teuchos::rcp;
+using Teuchos::RCP;
+using Teuchos::ParameterList;
+
+/* a two level p-multigrid v-cycle for the hierarchic basis. the
+   coarse space is given by the map of the vertex dofs, which are
+   the p=1 dofs, so prolongation is injection and the coarse operator
+   is the galerkin product P^T A P. the fine level is smoothed with
+   ilut and the coarse level is factored directly when amesos2 is
+   available and with ilut otherwise. */
+
+class PMultigridPreconditioner : public Operator
+{
+  public:
+
+    PMultigridPreconditioner(
+        RCP<Matrix> A,
+        RCP<const Map> coarse_map,
+        RCP<const ParameterList> sub_params);
+
+    RCP<const Map> getDomainMap() const;
+    RCP<const Map> getRangeMap() const;
+
+    void apply(
+        MultiVector const& X,
+        MultiVector& Y,
+        Teuchos::ETransp mode = Teuchos::NO_TRANS,
+        ST alpha = Teuchos::ScalarTraits<ST>::one(),
+        ST beta = Teuchos::ScalarTraits<ST>::zero()) const;
+
+  private:
+
+    RCP<Matrix> fine;
+    RCP<Matrix> coarse;
+    RCP<Matrix> prolongation;
+    RCP<Operator> smoother;
+    RCP<Operator> coarse_inverse;
+    RCP<Amesos2::Solver<Matrix, MultiVector> > coarse_direct;
+
+    void coarse_solve(MultiVector const& R, MultiVector& E) const;
+
+};
+
+}
+
+#endif
@@ -1,5 +1,6 @@
 #include "primal_problem.hpp"
 #include "linear_solver.hpp"
+#include "update_history.hpp"
 #include "mesh.hpp"
 #include "mechanics.hpp"
 #include "solution_info.hpp"
@@ -7,6 +8,9 @@
 #include "assert_param.hpp"
 #include "control.hpp"
 
+#include <cmath>
+#include <algorithm>
+
 namespace goal {
 
 static RCP<ParameterList> get_valid_params()
@@ -15,8 +19,21 @@ static RCP<ParameterList> get_valid_params()
   p->set<double>("linear: tolerance", 0.0);
   p->set<unsigned>("linear: max iters", 0);
   p->set<unsigned>("linear: krylov size", 0);
+  p->set<std::string>("linear: solver", "");
+  p->set<std::string>("linear: preconditioner", "");
+  p->set<bool>("linear: single precision", false);
+  p->set<std::string>("linear: orthogonalization", "");
+  p->set<unsigned>("linear: overlap", 0);
+  p->set<unsigned>("linear: level of fill", 0);
+  p->set<std::string>("linear: direct solver", "");
+  p->set<unsigned>("linear: recycle size", 0);
+  p->set<unsigned>("linear: guess history", 0);
+  p->set<bool>("linear: baseline comparison", false);
+  p->set<bool>("dual: transpose primal jacobian", false);
   p->set<double>("nonlinear: tolerance", 0.0);
   p->set<unsigned>("nonlinear: max iters", 0);
+  p->set<double>("nonlinear: check jacobian", 0.0);
+  p->set<double>("linear: check symmetry", 0.0);
   return p;
 }
 
@@ -30,6 +47,18 @@ static void validate_params(RCP<const ParameterList> p)
   p->validateParameters(*get_valid_params(), 0);
 }
 
+/* the default solver, gmres with an ilut preconditioner and no
+   initial guess, to measure the linear solver options against */
+static RCP<ParameterList> get_baseline_params(RCP<const ParameterList> p)
+{
+  RCP<ParameterList> bp = rcp(new ParameterList);
+  bp->set<double>("linear: tolerance", p->get<double>("linear: tolerance"));
+  bp->set<unsigned>("linear: max iters", p->get<unsigned>("linear: max iters"));
+  bp->set<unsigned>("linear: krylov size",
+      p->get<unsigned>("linear: krylov size"));
+  return bp;
+}
+
 PrimalProblem::PrimalProblem(
     RCP<const ParameterList> p,
     RCP<Mesh> m,
@@ -43,11 +72,40 @@ PrimalProblem::PrimalProblem(
   t_old(0.0),
   alpha(0.0),
   beta(0.0),
-  gamma(0.0)
+  gamma(0.0),
+  num_iters(0),
+  linear_iters(0),
+  baseline_iters(0),
+  num_reductions(0),
+  num_single_applies(0),
+  goal_tolerance(0.0),
+  check_tolerance(0.0),
+  symmetry_tolerance(0.0),
+  is_linear(false)
 {
   validate_params(params);
   tolerance = params->get<double>("nonlinear: tolerance");
   max_iters = params->get<unsigned>("nonlinear: max iters");
+  if (params->isParameter("nonlinear: check jacobian"))
+    check_tolerance = params->get<double>("nonlinear: check jacobian");
+  /* the lifted residual of the symmetric elimination is only formed
+     with the jacobian, so a residual sweep cannot difference it */
+  if ((check_tolerance > 0.0) && mechanics->is_symmetric_dirichlet())
+    fail("jacobian check does not support symmetric dirichlet elimination");
+  if (params->isParameter("linear: check symmetry"))
+    symmetry_tolerance = params->get<double>("linear: check symmetry");
+  /* the symmetric dirichlet lifting is applied while the jacobian is
+     assembled, so a reused jacobian would pair with an unlifted
+     residual */
+  is_linear = mechanics->is_linear() && (! mechanics->is_symmetric_dirichlet());
+  linear_solver = rcp(new LinearSolver(params));
+  if (mechanics->is_mixed())
+    linear_solver->set_block_split(
+        mechanics->get_num_eqs(), mechanics->get_offset("p"));
+  history = rcp(new UpdateHistory(params));
+  if (params->isParameter("linear: baseline comparison") &&
+      params->get<bool>("linear: baseline comparison"))
+    baseline_solver = rcp(new LinearSolver(get_baseline_params(params)));
 }
 
 struct PrimalInfo
@@ -70,6 +128,7 @@ void PrimalProblem::set_coeffs(double a, double b, double c)
   alpha = a;
   beta = b;
   gamma = c;
+  linear_jacobian = Teuchos::null;
 }
 
 static void load_overlap_solution(Workset& ws, RCP<SolutionInfo> s)
@@ -103,6 +162,7 @@ static void load_mesh_info(
 {
   std::string const& set = m->get_elem_set_name(set_idx);
   ws.set = set;
+  ws.ws_idx = ws_idx;
   ws.ents = m->get_elems(set, ws_idx);
   ws.size = ws.ents.size();
 }
@@ -173,13 +233,13 @@ void PrimalProblem::compute_residual()
   print("  residual computed in %f seconds", t1-t0);
 }
 
+template <typename D>
 static void compute_volumetric_jacobian(
     RCP<Mesh> m,
     RCP<Mechanics> mech,
     RCP<SolutionInfo> s,
     PrimalInfo* info)
 {
-  typedef GoalTraits::Derivative D;
   FieldManagers f = mech->get_volumetric();
   Workset ws;
   load_overlap_solution(ws, s);
@@ -197,13 +257,13 @@ static void compute_volumetric_jacobian(
   }
 }
 
+template <typename D>
 static void compute_neumann_jacobian(
     RCP<Mesh> m,
     RCP<Mechanics> mech,
     RCP<SolutionInfo> s,
     PrimalInfo* info)
 {
-  typedef GoalTraits::Derivative D;
   FieldManager f = mech->get_neumann();
   Workset ws;
   load_overlap_solution(ws, s);
@@ -215,13 +275,13 @@ static void compute_neumann_jacobian(
   f->evaluateFields<D>(ws);
 }
 
+template <typename D>
 static void compute_dirichlet_jacobian(
     RCP<Mesh> m,
     RCP<Mechanics> mech,
     RCP<SolutionInfo> s,
     PrimalInfo* info)
 {
-  typedef GoalTraits::Derivative D;
   FieldManager f = mech->get_dirichlet();
   Workset ws;
   load_owned_solution(ws, s);
@@ -244,42 +304,162 @@ void PrimalProblem::compute_jacobian()
   sol_info->owned_jacobian->setAllToScalar(0.0);
   sol_info->ovlp_jacobian->setAllToScalar(0.0);
   PrimalInfo primal_info = {t_new,t_old,alpha,beta,gamma};
-  compute_volumetric_jacobian(mesh, mechanics, sol_info, &primal_info);
-  compute_neumann_jacobian(mesh, mechanics, sol_info, &primal_info);
+  unsigned num_dofs = mesh->get_num_elem_dofs();
+  GOAL_DISPATCH_DERIVATIVE(num_dofs, compute_volumetric_jacobian,
+      mesh, mechanics, sol_info, &primal_info);
+  GOAL_DISPATCH_DERIVATIVE(num_dofs, compute_neumann_jacobian,
+      mesh, mechanics, sol_info, &primal_info);
   sol_info->ovlp_jacobian->fillComplete();
   sol_info->gather_residual();
   sol_info->gather_jacobian();
-  compute_dirichlet_jacobian(mesh, mechanics, sol_info, &primal_info);
+  GOAL_DISPATCH_DERIVATIVE(num_dofs, compute_dirichlet_jacobian,
+      mesh, mechanics, sol_info, &primal_info);
   sol_info->owned_jacobian->fillComplete();
+  sol_info->primal_jacobian = true;
   double t1 = time();
   print("  jacobian computed in %f seconds", t1-t0);
 }
 
-void PrimalProblem::solve()
+/* compares the jacobian against a finite difference of the residual
+   in a random direction v, ||J v - (R(u + eps v) - R(u))/eps|| over
+   ||J v||. the residual sweeps only evaluate the Forward type, so this
+   checks the derivative evaluators (local ad, analytic tangents, fused
+   kernels) against the values they are meant to differentiate. */
+void PrimalProblem::check_jacobian()
+{
+  RCP<Matrix> J = sol_info->owned_jacobian;
+  RCP<Vector> u = sol_info->owned_solution->getVectorNonConst(0);
+  RCP<Vector> r = sol_info->owned_residual;
+  RCP<const Map> map = mesh->get_owned_map();
+  Vector u0(map);
+  Vector r0(map);
+  Vector v(map);
+  Vector Jv(map);
+  u0.assign(*u);
+  r0.assign(*r);
+  v.randomize();
+  J->apply(v, Jv);
+  double eps = 1.0e-7*(1.0 + u->normInf());
+  u->update(eps, v, 1.0);
+  compute_residual();
+  r->update(-1.0/eps, r0, 1.0/eps);
+  r->update(-1.0, Jv, 1.0);
+  double error = r->norm2()/Jv.norm2();
+  u->assign(u0);
+  r->assign(r0);
+  sol_info->scatter_solution();
+  print("  jacobian check relative error: %e", error);
+  if (error > check_tolerance)
+    fail("jacobian check failed: %e > %e", error, check_tolerance);
+}
+
+/* compares w^T J v against v^T J w for random v and w, relative to
+   ||w|| ||J v||. cg needs the symmetric dirichlet elimination to leave
+   the assembled jacobian symmetric. */
+void PrimalProblem::check_symmetry()
+{
+  RCP<Matrix> J = sol_info->owned_jacobian;
+  RCP<const Map> map = mesh->get_owned_map();
+  Vector v(map);
+  Vector w(map);
+  Vector Jv(map);
+  Vector Jw(map);
+  v.randomize();
+  w.randomize();
+  J->apply(v, Jv);
+  J->apply(w, Jw);
+  double a = w.dot(Jv);
+  double b = v.dot(Jw);
+  double error = std::abs(a - b)/(w.norm2()*Jv.norm2());
+  print("  jacobian symmetry relative error: %e", error);
+  if (error > symmetry_tolerance)
+    fail("symmetry check failed: %e > %e", error, symmetry_tolerance);
+}
+
+/* only the gram-schmidt gmres counts its global reductions, the
+   belos solvers report none rather than an estimate */
+bool PrimalProblem::counts_reductions()
+{
+  return linear_solver->counts_reductions();
+}
+
+/* solves the system of the last newton iteration again with the
+   baseline solver from a zero guess and records its iterations */
+void PrimalProblem::solve_baseline(RCP<Matrix> J, RCP<Vector> r, double tol)
+{
+  print("  baseline comparison solve");
+  RCP<Vector> x = rcp(new Vector(mesh->get_owned_map()));
+  baseline_solver->set_tolerance(tol);
+  baseline_solver->solve(J, x, r);
+  baseline_iters += baseline_solver->get_num_iters();
+}
+
+/* an inexact newton forcing term: the linear solve only needs to
+   bring the linearized residual down to about the newton tolerance. */
+static double get_forcing(
+    RCP<const ParameterList> p,
+    double tol,
+    double norm)
+{
+  double min_tol = p->get<double>("linear: tolerance");
+  double forcing = 0.5 * tol / norm;
+  return std::min(0.1, std::max(min_tol, forcing));
+}
+
+bool PrimalProblem::solve()
 {
   print("solving primal model");
   RCP<Matrix> J = sol_info->owned_jacobian;
   RCP<Vector> u = sol_info->owned_solution->getVectorNonConst(0);
   RCP<Vector> r = sol_info->owned_residual;
   RCP<Vector> du = rcp(new Vector(mesh->get_owned_map()));
+  double tol = std::max(tolerance, goal_tolerance);
+  if (goal_tolerance > 0.0)
+    print(" goal-driven newton tolerance: %e", tol);
   unsigned iter=1;
   bool converged = false;
   while ((iter <= max_iters) && (! converged)) {
     print(" (%d) newton iteration", iter);
-    compute_jacobian();
+    bool reuse = is_linear && (J == linear_jacobian) &&
+      sol_info->primal_jacobian;
+    if (! reuse)
+      compute_jacobian();
+    else if (iter == 1)
+      compute_residual();
+    if ((! reuse) && (check_tolerance > 0.0))
+      check_jacobian();
+    if ((! reuse) && (symmetry_tolerance > 0.0))
+      check_symmetry();
+    if (is_linear)
+      linear_jacobian = J;
+    double forcing = 0.0;
+    if (goal_tolerance > 0.0)
+      forcing = get_forcing(params, tol, r->norm2());
+    linear_solver->set_tolerance(forcing);
     r->scale(-1.0);
-    du->putScalar(0.0);
-    solve_linear_system(params, J, du, r);
+    history->guess(J, du, r);
+    linear_solver->set_reuse(reuse);
+    linear_solver->set_coarse_map(mesh->get_vertex_map());
+    linear_solver->solve(J, du, r);
+    linear_iters += linear_solver->get_num_iters();
+    iter_history.push_back(linear_solver->get_num_iters());
+    num_reductions += linear_solver->get_num_reductions();
+    num_single_applies += linear_solver->get_num_single_applies();
+    if (baseline_solver != Teuchos::null)
+      solve_baseline(J, r, forcing);
+    history->add(du);
     u->update(1.0, *du, 1.0);
     compute_residual();
     double norm = r->norm2();
     print("  ||r|| = %e", norm);
-    if (norm < tolerance) converged = true;
+    if (norm < tol) converged = true;
     iter++;
   }
-  if ((iter > max_iters) && (!converged))
-    fail("newton's method failed in %u iterations", max_iters);
+  num_iters = iter-1;
+  if (! converged)
+    print("newton's method failed in %u iterations", max_iters);
   du = Teuchos::null;
+  return converged;
 }
 
 RCP<PrimalProblem> primal_create(
@@ -1,8 +1,12 @@
 #ifndef goal_primal_problem_hpp
 #define goal_primal_problem_hpp
 
+#include "data_types.hpp"
+
 #include <Teuchos_RCP.hpp>
 
+#include <vector>
+
 namespace Teuchos {
 class ParameterList;
 }
@@ -16,6 +20,8 @@ using Teuchos::ParameterList;
 class Mesh;
 class Mechanics;
 class SolutionInfo;
+class LinearSolver;
+class UpdateHistory;
 
 class PrimalProblem
 {
@@ -35,7 +41,25 @@ class PrimalProblem
 
     void compute_jacobian();
 
-    void solve();
+    bool solve();
+
+    unsigned get_num_iters() {return num_iters;}
+
+    unsigned get_linear_iters() {return linear_iters;}
+
+    std::vector<unsigned> const& get_iter_history() {return iter_history;}
+
+    bool has_baseline() {return baseline_solver != Teuchos::null;}
+
+    unsigned get_baseline_iters() {return baseline_iters;}
+
+    bool counts_reductions();
+
+    unsigned get_num_reductions() {return num_reductions;}
+
+    unsigned get_num_single_applies() {return num_single_applies;}
+
+    void set_goal_tolerance(double t) {goal_tolerance = t;}
 
   private:
 
@@ -43,6 +67,9 @@ class PrimalProblem
     RCP<Mesh> mesh;
     RCP<Mechanics> mechanics;
     RCP<SolutionInfo> sol_info;
+    RCP<LinearSolver> linear_solver;
+    RCP<LinearSolver> baseline_solver;
+    RCP<UpdateHistory> history;
 
     double t_new;
     double t_old;
@@ -53,6 +80,24 @@ class PrimalProblem
 
     double tolerance;
     unsigned max_iters;
+    unsigned num_iters;
+    unsigned linear_iters;
+    unsigned baseline_iters;
+    std::vector<unsigned> iter_history;
+    unsigned num_reductions;
+    unsigned num_single_applies;
+    double goal_tolerance;
+    double check_tolerance;
+    double symmetry_tolerance;
+
+    bool is_linear;
+    RCP<Matrix> linear_jacobian;
+
+    void check_jacobian();
+
+    void check_symmetry();
+
+    void solve_baseline(RCP<Matrix> J, RCP<Vector> r, double tol);
 
 };
 
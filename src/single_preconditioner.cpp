@@ -0,0 +1,92 @@
+#include "single_preconditioner.hpp"
+
+#ifdef GOAL_MIXED_PRECISION
+
+#include <Ifpack2_Factory.hpp>
+
+namespace goal {
+
+typedef Tpetra::RowMatrix<SST, LO, GO, KNode> SingleRowMatrix;
+typedef Ifpack2::Preconditioner<SST, LO, GO, KNode> SingleIfpackPrec;
+
+static RCP<SingleMatrix> convert_matrix(RCP<Matrix> A)
+{
+  RCP<SingleMatrix> B = rcp(new SingleMatrix(A->getCrsGraph()));
+  Teuchos::ArrayView<const LO> indices;
+  Teuchos::ArrayView<const ST> entries;
+  Teuchos::Array<SST> single_entries;
+  LO num_rows = A->getNodeNumRows();
+  for (LO row=0; row < num_rows; ++row) {
+    A->getLocalRowView(row, indices, entries);
+    single_entries.resize(entries.size());
+    for (unsigned i=0; i < entries.size(); ++i)
+      single_entries[i] = entries[i];
+    B->replaceLocalValues(row, indices, single_entries());
+  }
+  B->fillComplete(A->getDomainMap(), A->getRangeMap());
+  return B;
+}
+
+SinglePreconditioner::SinglePreconditioner(
+    RCP<Matrix> A,
+    std::string const& type,
+    RCP<const ParameterList> p) :
+  num_applies(0)
+{
+  map = A->getRowMap();
+  RCP<SingleMatrix> B = convert_matrix(A);
+  Ifpack2::Factory factory;
+  RCP<SingleIfpackPrec> prec = factory.create<SingleRowMatrix>(type, B);
+  prec->setParameters(*p);
+  prec->initialize();
+  prec->compute();
+  inverse = prec;
+}
+
+RCP<const Map> SinglePreconditioner::getDomainMap() const
+{
+  return map;
+}
+
+RCP<const Map> SinglePreconditioner::getRangeMap() const
+{
+  return map;
+}
+
+void SinglePreconditioner::apply(
+    MultiVector const& X,
+    MultiVector& Y,
+    Teuchos::ETransp mode,
+    ST alpha,
+    ST beta) const
+{
+  CHECK(mode == Teuchos::NO_TRANS);
+  size_t nv = X.getNumVectors();
+  size_t n = X.getLocalLength();
+  if ((x == Teuchos::null) || (x->getNumVectors() != nv)) {
+    x = rcp(new SingleMultiVector(map, nv));
+    y = rcp(new SingleMultiVector(map, nv));
+  }
+  for (size_t j=0; j < nv; ++j) {
+    ArrayRCP<const ST> xd = X.getVector(j)->get1dView();
+    ArrayRCP<SST> xs = x->getVectorNonConst(j)->get1dViewNonConst();
+    for (size_t i=0; i < n; ++i)
+      xs[i] = xd[i];
+  }
+  inverse->apply(*x, *y);
+  num_applies++;
+  for (size_t j=0; j < nv; ++j) {
+    ArrayRCP<const SST> ys = y->getVector(j)->get1dView();
+    ArrayRCP<ST> yd = Y.getVectorNonConst(j)->get1dViewNonConst();
+    if (beta == 0.0)
+      for (size_t i=0; i < n; ++i)
+        yd[i] = alpha*ys[i];
+    else
+      for (size_t i=0; i < n; ++i)
+        yd[i] = beta*yd[i] + alpha*ys[i];
+  }
+}
+
+}
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef goal_single_preconditioner_hpp
+#define goal_single_preconditioner_hpp
+
+#include "data_types.hpp"
+#include "control.hpp"
+
+#ifdef GOAL_MIXED_PRECISION
+
+namespace goal {
+
+using Teuchos::rcp;
+using Teuchos::ArrayRCP;
+using Teuchos::RCP;
+using Teuchos::ParameterList;
+
+typedef float SST;
+typedef Tpetra::MultiVector<SST, LO, GO, KNode> SingleMultiVector;
+typedef Tpetra::CrsMatrix<SST, LO, GO, KNode> SingleMatrix;
+typedef Tpetra::Operator<SST, LO, GO, KNode> SingleOperator;
+
+/* an ifpack2 preconditioner built and applied in single precision
+   for use inside a double precision krylov iteration. the single
+   precision vectors are kept between applies with the same number
+   of vectors. */
+
+class SinglePreconditioner : public Operator
+{
+  public:
+
+    SinglePreconditioner(
+        RCP<Matrix> A,
+        std::string const& type,
+        RCP<const ParameterList> p);
+
+    RCP<const Map> getDomainMap() const;
+    RCP<const Map> getRangeMap() const;
+
+    void apply(
+        MultiVector const& X,
+        MultiVector& Y,
+        Teuchos::ETransp mode = Teuchos::NO_TRANS,
+        ST alpha = Teuchos::ScalarTraits<ST>::one(),
+        ST beta = Teuchos::ScalarTraits<ST>::zero()) const;
+
+    unsigned get_num_applies() const {return num_applies;}
+
+  private:
+
+    RCP<const Map> map;
+    RCP<SingleOperator> inverse;
+
+    mutable RCP<SingleMultiVector> x;
+    mutable RCP<SingleMultiVector> y;
+    mutable unsigned num_applies;
+
+};
+
+}
+
+#endif
+
+#endif
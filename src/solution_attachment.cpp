@@ -10,12 +10,17 @@
 
 namespace goal {
 
-static Teuchos::Array<std::string> get_dual_names(RCP<Mechanics> mech)
+static Teuchos::Array<std::string> get_dual_names(
+    RCP<Mechanics> mech,
+    unsigned qoi)
 {
   Teuchos::Array<std::string> names = mech->get_dof_names();
   Teuchos::Array<std::string> dual_names(0);
+  std::string suffix = "_dual";
+  if (qoi > 0)
+    suffix += "_" + std::to_string(qoi);
   for (unsigned i=0; i < names.size(); ++i)
-    dual_names.push_back(names[i] + "_dual");
+    dual_names.push_back(names[i] + suffix);
   return dual_names;
 }
 
@@ -64,7 +69,8 @@ static void attach_vector_to_shape(
     RCP<const Vector> u,
     RCP<Mesh> mesh,
     RCP<Mechanics> mech,
-    Teuchos::Array<std::string> const& names)
+    Teuchos::Array<std::string> const& names,
+    Teuchos::Array<std::string> const& offset_names)
 {
   ArrayRCP<const ST> data = u->get1dView();
   apf::Mesh* m = mesh->get_apf_mesh();
@@ -79,7 +85,7 @@ static void attach_vector_to_shape(
     apf::Node* node = &(nodes[i]);
     if (! m->isOwned(node->entity)) continue;
     for (unsigned j=0; j < names.size(); ++j) {
-      unsigned eq = mech->get_offset(names[j]);
+      unsigned eq = mech->get_offset(offset_names[j]);
       LO row = mesh->get_lid(node, eq);
       double v = data[row];
       apf::setScalar(fields[j], node->entity, node->node, v);
@@ -96,15 +102,16 @@ void attach_solutions_to_shape(AttachInfo& ai)
   for (unsigned i=0; i < nv; ++i) {
     RCP<const Vector> u = sv->getVector(i);
     Teuchos::Array<std::string> names = ai.mech->get_var_names(i);
-    attach_vector_to_shape(u, ai.mesh, ai.mech, names);
+    attach_vector_to_shape(u, ai.mesh, ai.mech, names, names);
   }
 }
 
-void fill_vector_from_fields(
+static void fill_vector_from_fields(
     RCP<Vector> u,
     RCP<Mesh> mesh,
     RCP<Mechanics> mech,
-    Teuchos::Array<std::string> const& names)
+    Teuchos::Array<std::string> const& names,
+    Teuchos::Array<std::string> const& offset_names)
 {
   ArrayRCP<ST> data = u->get1dViewNonConst();
   apf::Mesh* m = mesh->get_apf_mesh();
@@ -119,7 +126,7 @@ void fill_vector_from_fields(
     apf::Node* node = &(nodes[i]);
     if (! m->isOwned(node->entity)) continue;
     for (unsigned j=0; j < names.size(); ++j) {
-      unsigned eq = mech->get_offset(names[j]);
+      unsigned eq = mech->get_offset(offset_names[j]);
       LO row = mesh->get_lid(node, eq);
       double v = apf::getScalar(fields[j], node->entity, node->node);
       data[row] = v;
@@ -134,17 +141,64 @@ void fill_solutions_from_fields(AttachInfo& ai)
   for (unsigned i=0; i < nv; ++i) {
     RCP<Vector> u = sv->getVectorNonConst(i);
     Teuchos::Array<std::string> names = ai.mech->get_var_names(i);
-    fill_vector_from_fields(u, ai.mesh, ai.mech, names);
+    fill_vector_from_fields(u, ai.mesh, ai.mech, names, names);
   }
 }
 
 void attach_dual_solutions_to_mesh(AttachInfo& ai)
 {
   if (ai.sol_info->owned_dual == Teuchos::null) return;
-  RCP<Vector> z = ai.sol_info->owned_dual;
+  RCP<MultiVector> zs = ai.sol_info->owned_dual;
+  Teuchos::Array<std::string> offset_names = ai.mech->get_dof_names();
+  for (unsigned i=0; i < zs->getNumVectors(); ++i) {
+    RCP<Vector> z = zs->getVectorNonConst(i);
+    Teuchos::Array<std::string> dual_names = get_dual_names(ai.mech, i);
+    attach_vector_to_mesh(z, ai.mesh, ai.mech, dual_names, offset_names);
+  }
+}
+
+static Teuchos::Array<std::string> get_old_dual_names(
+    RCP<Mechanics> mech,
+    unsigned qoi)
+{
+  Teuchos::Array<std::string> names = get_dual_names(mech, qoi);
+  for (unsigned i=0; i < names.size(); ++i)
+    names[i] += "_old";
+  return names;
+}
+
+void attach_old_duals_to_shape(AttachInfo& ai)
+{
+  if (ai.sol_info->owned_dual == Teuchos::null) return;
+  RCP<MultiVector> zs = ai.sol_info->owned_dual;
   Teuchos::Array<std::string> offset_names = ai.mech->get_dof_names();
-  Teuchos::Array<std::string> dual_names = get_dual_names(ai.mech);
-  attach_vector_to_mesh(z, ai.mesh, ai.mech, dual_names, offset_names);
+  for (unsigned i=0; i < zs->getNumVectors(); ++i) {
+    RCP<const Vector> z = zs->getVector(i);
+    Teuchos::Array<std::string> names = get_old_dual_names(ai.mech, i);
+    attach_vector_to_shape(z, ai.mesh, ai.mech, names, offset_names);
+  }
+}
+
+/* the old duals are read through the nodes of the current shape, so
+   they are only used when they were attached on the same shape. any
+   remaining qoi starts from zero. */
+void fill_duals_from_old_fields(AttachInfo& ai)
+{
+  apf::Mesh* m = ai.mesh->get_apf_mesh();
+  RCP<MultiVector> zs = ai.sol_info->owned_dual;
+  Teuchos::Array<std::string> offset_names = ai.mech->get_dof_names();
+  for (unsigned i=0; ; ++i) {
+    Teuchos::Array<std::string> names = get_old_dual_names(ai.mech, i);
+    if (! m->findField(names[0].c_str())) break;
+    bool same = (apf::getShape(m->findField(names[0].c_str())) ==
+        ai.mesh->get_apf_shape());
+    if (same && (i < zs->getNumVectors())) {
+      RCP<Vector> z = zs->getVectorNonConst(i);
+      fill_vector_from_fields(z, ai.mesh, ai.mech, names, offset_names);
+    }
+    for (unsigned j=0; j < names.size(); ++j)
+      apf::destroyField(m->findField(names[j].c_str()));
+  }
 }
 
 void remove_solutions_from_mesh(AttachInfo& ai)
@@ -166,11 +220,14 @@ void remove_dual_solutions_from_mesh(AttachInfo& ai)
 {
   if (ai.sol_info->owned_dual == Teuchos::null) return;
   apf::Mesh* m = ai.mesh->get_apf_mesh();
-  Teuchos::Array<std::string> names = get_dual_names(ai.mech);
-  for (unsigned i=0; i < names.size(); ++i) {
-    apf::Field* f = m->findField(names[i].c_str());
-    CHECK(f);
-    apf::destroyField(f);
+  unsigned nq = ai.sol_info->owned_dual->getNumVectors();
+  for (unsigned j=0; j < nq; ++j) {
+    Teuchos::Array<std::string> names = get_dual_names(ai.mech, j);
+    for (unsigned i=0; i < names.size(); ++i) {
+      apf::Field* f = m->findField(names[i].c_str());
+      CHECK(f);
+      apf::destroyField(f);
+    }
   }
 }
 
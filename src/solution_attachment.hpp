@@ -24,6 +24,9 @@ void attach_dual_solutions_to_mesh(AttachInfo& i);
 void attach_solutions_to_shape(AttachInfo& i);
 void fill_solutions_from_fields(AttachInfo& i);
 
+void attach_old_duals_to_shape(AttachInfo& i);
+void fill_duals_from_old_fields(AttachInfo& i);
+
 void remove_solutions_from_mesh(AttachInfo& i);
 void remove_dual_solutions_from_mesh(AttachInfo& i);
 
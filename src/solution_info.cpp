@@ -25,22 +25,31 @@ void SolutionInfo::resize(
   ovlp_solution = rcp(new MultiVector(om, num_vectors));
   ovlp_residual = rcp(new Vector(om));
   ovlp_jacobian = rcp(new Matrix(og));
+  primal_jacobian = false;
   double t1 = time();
   print("solution containers resized in %f seconds", t1-t0);
 }
 
+static void copy_values(RCP<const MultiVector> from, RCP<MultiVector> to)
+{
+  unsigned nv = std::min(from->getNumVectors(), to->getNumVectors());
+  unsigned length = std::min(
+      from->getLocalLength(), to->getLocalLength());
+  for (unsigned j=0; j < nv; ++j) {
+    ArrayRCP<const ST> os = from->getData(j);
+    ArrayRCP<ST> s = to->getDataNonConst(j);
+    for (unsigned i=0; i < length; ++i)
+      s[i] = os[i];
+  }
+}
+
 void SolutionInfo::project(RCP<Mesh> m, bool enable_dynamics)
 {
   double t0 = time();
   RCP<MultiVector> old_solution(owned_solution);
   resize(m, enable_dynamics);
   owned_solution->putScalar(0.0);
-  ArrayRCP<const ST> os = old_solution->get1dView();
-  ArrayRCP<ST> s = owned_solution->get1dViewNonConst();
-  unsigned length = std::min(
-      old_solution->getLocalLength(), owned_solution->getLocalLength());
-  for (unsigned i=0; i < length; ++i)
-    s[i] = os[i];
+  copy_values(old_solution, owned_solution);
   scatter_solution();
   old_solution = Teuchos::null;
   double t1 = time();
@@ -48,14 +57,15 @@ void SolutionInfo::project(RCP<Mesh> m, bool enable_dynamics)
 }
 
 void SolutionInfo::create_dual_vectors(
-    RCP<Mesh> mesh)
+    RCP<Mesh> mesh,
+    unsigned num_qois)
 {
   RCP<const Map> m = mesh->get_owned_map();
   RCP<const Map> om = mesh->get_overlap_map();
-  owned_qoi = rcp(new Vector(m));
-  owned_dual = rcp(new Vector(m));
-  ovlp_qoi = rcp(new Vector(om));
-  ovlp_dual = rcp(new Vector(om));
+  owned_qoi = rcp(new MultiVector(m, num_qois));
+  owned_dual = rcp(new MultiVector(m, num_qois));
+  ovlp_qoi = rcp(new MultiVector(om, num_qois));
+  ovlp_dual = rcp(new MultiVector(om, num_qois));
 }
 
 void SolutionInfo::destroy_dual_vectors()
@@ -16,7 +16,7 @@ class SolutionInfo
   public:
     void resize(RCP<Mesh> m, bool enable_dynamics);
     void project(RCP<Mesh> m, bool enable_dynamics);
-    void create_dual_vectors(RCP<Mesh> m);
+    void create_dual_vectors(RCP<Mesh> m, unsigned num_qois);
     void destroy_dual_vectors();
     void gather_solution();
     void scatter_solution();
@@ -26,16 +26,17 @@ class SolutionInfo
     void gather_jacobian();
     RCP<MultiVector> owned_solution;
     RCP<Vector> owned_residual;
-    RCP<Vector> owned_qoi;
-    RCP<Vector> owned_dual;
+    RCP<MultiVector> owned_qoi;
+    RCP<MultiVector> owned_dual;
     RCP<Matrix> owned_jacobian;
     RCP<MultiVector> ovlp_solution;
     RCP<Vector> ovlp_residual;
-    RCP<Vector> ovlp_qoi;
-    RCP<Vector> ovlp_dual;
+    RCP<MultiVector> ovlp_qoi;
+    RCP<MultiVector> ovlp_dual;
     RCP<Matrix> ovlp_jacobian;
     RCP<Export> exporter;
     RCP<Import> importer;
+    bool primal_jacobian;
 };
 
 RCP<SolutionInfo> sol_info_create(RCP<Mesh> m, bool enable_dynamics);
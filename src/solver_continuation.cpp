@@ -7,9 +7,12 @@
 #include "output.hpp"
 #include "assert_param.hpp"
 #include "control.hpp"
+#include "parallel_elems.hpp"
 
 #include <Teuchos_ParameterList.hpp>
 
+#include <algorithm>
+
 namespace goal {
 
 static RCP<ParameterList> get_valid_params()
@@ -19,8 +22,22 @@ static RCP<ParameterList> get_valid_params()
   p->set<double>("initial time", 0.0);
   p->set<double>("step size", 0.0);
   p->set<unsigned>("num steps", 0);
+  p->set<bool>("adaptive stepping", false);
+  p->set<double>("adaptive: min step size", 0.0);
+  p->set<double>("adaptive: max step size", 0.0);
+  p->set<double>("adaptive: growth factor", 0.0);
+  p->set<double>("adaptive: cutback factor", 0.0);
+  p->set<unsigned>("adaptive: growth iters", 0);
   p->set<double>("regression: val", 0.0);
   p->set<double>("regression: tol", 0.0);
+  p->set<unsigned>("regression: num steps", 0);
+  p->set<unsigned>("regression: min cutbacks", 0);
+  p->set<unsigned>("regression: max linear iters", 0);
+  p->set<double>("regression: max reductions per iter", 0.0);
+  p->set<double>("regression: max baseline ratio", 0.0);
+  p->set<bool>("regression: later iters below first", false);
+  p->set<bool>("regression: single precision applies", false);
+  p->set<unsigned>("regression: min threads", 0);
   p->sublist("mesh");
   p->sublist("mechanics");
   p->sublist("linear algebra");
@@ -38,6 +55,10 @@ static void validate_params(RCP<const ParameterList> p)
   assert_sublist(p, "mesh");
   assert_sublist(p, "mechanics");
   assert_sublist(p, "output");
+  if (p->isParameter("adaptive stepping") && p->get<bool>("adaptive stepping")) {
+    assert_param(p, "adaptive: min step size");
+    assert_param(p, "adaptive: max step size");
+  }
   p->validateParameters(*get_valid_params(), 0);
 }
 
@@ -46,7 +67,15 @@ SolverContinuation::SolverContinuation(RCP<const ParameterList> p) :
   t_old(0.0),
   t_new(0.0),
   dt(0.0),
-  num_steps(0)
+  num_steps(0),
+  adaptive(false),
+  dt_min(0.0),
+  dt_max(0.0),
+  growth(1.5),
+  cutback(0.5),
+  growth_iters(3),
+  steps_taken(0),
+  num_cutbacks(0)
 {
   print("--- continuation solver ---");
   validate_params(params);
@@ -63,6 +92,22 @@ SolverContinuation::SolverContinuation(RCP<const ParameterList> p) :
   dt = params->get<double>("step size");
   num_steps = params->get<unsigned>("num steps");
   t_new = t_old + dt;
+  if (params->isParameter("adaptive stepping"))
+    adaptive = params->get<bool>("adaptive stepping");
+  if (adaptive) {
+    dt_min = params->get<double>("adaptive: min step size");
+    dt_max = params->get<double>("adaptive: max step size");
+    if (params->isParameter("adaptive: growth factor"))
+      growth = params->get<double>("adaptive: growth factor");
+    if (params->isParameter("adaptive: cutback factor"))
+      cutback = params->get<double>("adaptive: cutback factor");
+    if (params->isParameter("adaptive: growth iters"))
+      growth_iters = params->get<unsigned>("adaptive: growth iters");
+    CHECK(dt_min > 0.0);
+    CHECK(dt_min <= dt_max);
+    CHECK(growth >= 1.0);
+    CHECK((cutback > 0.0) && (cutback < 1.0));
+  }
 }
 
 static void check_regression(
@@ -78,16 +123,103 @@ static void check_regression(
   CHECK(std::abs(computed-expected) < tol);
 }
 
-void SolverContinuation::solve()
+/* checks on what the solver options change rather than on the
+   solution: the steps taken and the failed steps cut back by adaptive
+   stepping, the largest number of iterations of any linear solve, the
+   global reductions counted per linear iteration, the
+   linear iterations against those of the baseline solver on the same
+   systems, the iterations of later linear solves against the first,
+   which a recycled subspace should reduce, and that the single
+   precision preconditioner was applied. */
+static void check_stats(
+    RCP<const ParameterList> p,
+    RCP<PrimalProblem> primal,
+    unsigned steps,
+    unsigned cutbacks)
+{
+  if (p->isParameter("regression: num steps")) {
+    unsigned expected = p->get<unsigned>("regression: num steps");
+    print("expected continuation steps: %u", expected);
+    print("computed continuation steps: %u", steps);
+    CHECK(steps == expected);
+  }
+  if (p->isParameter("regression: min cutbacks")) {
+    unsigned bound = p->get<unsigned>("regression: min cutbacks");
+    print("required step cutbacks: %u", bound);
+    print("computed step cutbacks: %u", cutbacks);
+    CHECK(cutbacks >= bound);
+  }
+  if (p->isParameter("regression: max linear iters")) {
+    unsigned bound = p->get<unsigned>("regression: max linear iters");
+    std::vector<unsigned> const& h = primal->get_iter_history();
+    CHECK(h.size() > 0);
+    unsigned iters = 0;
+    for (size_t i=0; i < h.size(); ++i)
+      iters = std::max(iters, h[i]);
+    print("allowed linear iterations: %u", bound);
+    print("maximum linear iterations: %u", iters);
+    CHECK(iters <= bound);
+  }
+  if (p->isParameter("regression: max reductions per iter")) {
+    double bound = p->get<double>("regression: max reductions per iter");
+    if (! primal->counts_reductions())
+      fail("global reductions are only counted by gmres with icgs or dcgs2");
+    unsigned count = primal->get_num_reductions();
+    unsigned iters = primal->get_linear_iters();
+    CHECK((count > 0) && (iters > 0));
+    double per_iter = double(count)/double(iters);
+    print("allowed reductions per iteration: %f", bound);
+    print("counted reductions per iteration: %f", per_iter);
+    CHECK(per_iter <= bound);
+  }
+  if (p->isParameter("regression: max baseline ratio")) {
+    double bound = p->get<double>("regression: max baseline ratio");
+    if (! primal->has_baseline())
+      fail("max baseline ratio requires linear: baseline comparison");
+    unsigned iters = primal->get_linear_iters();
+    unsigned baseline = primal->get_baseline_iters();
+    CHECK(baseline > 0);
+    double ratio = double(iters)/double(baseline);
+    print("baseline linear iterations: %u", baseline);
+    print("computed linear iterations: %u", iters);
+    print("allowed iteration ratio: %f", bound);
+    CHECK(ratio < bound);
+  }
+  if (p->isParameter("regression: later iters below first") &&
+      p->get<bool>("regression: later iters below first")) {
+    std::vector<unsigned> const& h = primal->get_iter_history();
+    CHECK(h.size() > 1);
+    double later = 0.0;
+    for (size_t i=1; i < h.size(); ++i)
+      later += h[i];
+    later /= double(h.size()-1);
+    print("first solve linear iterations: %u", h[0]);
+    print("mean later linear iterations: %f", later);
+    CHECK(later < h[0]);
+  }
+  if (p->isParameter("regression: single precision applies") &&
+      p->get<bool>("regression: single precision applies")) {
+    unsigned applies = primal->get_num_single_applies();
+    print("single precision preconditioner applies: %u", applies);
+    CHECK(applies > 0);
+  }
+  if (p->isParameter("regression: min threads")) {
+    unsigned bound = p->get<unsigned>("regression: min threads");
+    unsigned threads = get_num_elem_threads();
+    print("element loop threads: %u", threads);
+    CHECK(threads >= bound);
+  }
+}
+
+void SolverContinuation::solve_fixed()
 {
-  mechanics->build_primal();
-  sol_info->ovlp_solution->putScalar(0.0);
   for (unsigned step=1; step <= num_steps; ++step) {
     print("*** Continuation Step: (%u)", step);
     print("*** from time:         %f", t_old);
     print("*** to time:           %f", t_new);
     primal->set_time(t_new, t_old);
-    primal->solve();
+    if (! primal->solve())
+      fail("primal problem failed to converge");
     output->write(t_new);
     if (Teuchos::nonnull(adapter) && step < num_steps)
       adapter->adapt(step);
@@ -95,8 +227,64 @@ void SolverContinuation::solve()
     t_new = t_new + dt;
     mechanics->update_state();
   }
+  steps_taken = num_steps;
+}
+
+void SolverContinuation::solve_adaptive()
+{
+  double t_final = t_old + num_steps*dt;
+  double t_eps = 1.0e-12*std::max(1.0, std::abs(t_final));
+  dt = std::min(std::max(dt, dt_min), dt_max);
+  unsigned step = 1;
+  while (t_old < t_final - t_eps) {
+
+    /* save the converged state in case this step must be retried */
+    RCP<MultiVector> u = sol_info->owned_solution;
+    RCP<MultiVector> u_saved =
+      rcp(new MultiVector(u->getMap(), u->getNumVectors()));
+    u_saved->assign(*u);
+
+    t_new = std::min(t_old + dt, t_final);
+    print("*** Continuation Step: (%u)", step);
+    print("*** from time:         %f", t_old);
+    print("*** to time:           %f", t_new);
+    primal->set_time(t_new, t_old);
+
+    /* cut back the step size on failure and retry from the saved state */
+    if (! primal->solve()) {
+      u->assign(*u_saved);
+      sol_info->scatter_solution();
+      dt = cutback*(t_new - t_old);
+      num_cutbacks++;
+      if (dt < dt_min)
+        fail("step size %e fell below the minimum %e", dt, dt_min);
+      print("*** step failed, retrying with step size: %f", dt);
+      continue;
+    }
+
+    /* grow the step size if newton converged quickly */
+    if (primal->get_num_iters() <= growth_iters)
+      dt = std::min(growth*dt, dt_max);
+
+    output->write(t_new);
+    if (Teuchos::nonnull(adapter) && t_new < t_final - t_eps)
+      adapter->adapt(step);
+    t_old = t_new;
+    mechanics->update_state();
+    step++;
+  }
+  steps_taken = step-1;
+}
+
+void SolverContinuation::solve()
+{
+  mechanics->build_primal();
+  sol_info->ovlp_solution->putScalar(0.0);
+  if (adaptive) solve_adaptive();
+  else solve_fixed();
   if (params->isParameter("regression: val"))
     check_regression(params, sol_info);
+  check_stats(params, primal, steps_taken, num_cutbacks);
 }
 
 }
@@ -29,6 +29,16 @@ class SolverContinuation : public Solver
     double t_new;
     double dt;
     unsigned num_steps;
+    bool adaptive;
+    double dt_min;
+    double dt_max;
+    double growth;
+    double cutback;
+    unsigned growth_iters;
+    unsigned steps_taken;
+    unsigned num_cutbacks;
+    void solve_fixed();
+    void solve_adaptive();
 };
 
 }
@@ -6,9 +6,12 @@
 #include "dual_problem.hpp"
 #include "error_estimation.hpp"
 #include "output.hpp"
+#include "solution_attachment.hpp"
 #include "control.hpp"
 #include "assert_param.hpp"
 
+#include <cmath>
+
 namespace goal {
 
 static RCP<ParameterList> get_valid_params()
@@ -18,6 +21,11 @@ static RCP<ParameterList> get_valid_params()
   p->set<double>("initial time", 0.0);
   p->set<double>("step size", 0.0);
   p->set<unsigned>("num steps", 0.0);
+  p->set<bool>("dual enrichment", true);
+  p->set<double>("algebraic error fraction", 0.0);
+  p->set<double>("regression: val", 0.0);
+  p->set<double>("regression: tol", 0.0);
+  p->set<bool>("regression: distinct duals", false);
   p->sublist("mesh");
   p->sublist("mechanics");
   p->sublist("error estimation");
@@ -46,7 +54,9 @@ SolverGoalContinuation::SolverGoalContinuation(
   t_old(0.0),
   t_new(0.0),
   dt(0.0),
-  num_steps(0)
+  num_steps(0),
+  enrich_dual(true),
+  algebraic_fraction(0.0)
 {
   print("--- goal-oriented adaptive continuation solver ---");
   validate_params(params);
@@ -63,6 +73,14 @@ SolverGoalContinuation::SolverGoalContinuation(
   t_old = params->get<double>("initial time");
   dt = params->get<double>("step size");
   num_steps = params->get<unsigned>("num steps");
+  if (params->isParameter("dual enrichment"))
+    enrich_dual = params->get<bool>("dual enrichment");
+  if (params->isParameter("algebraic error fraction"))
+    algebraic_fraction = params->get<double>("algebraic error fraction");
+  /* on the primal discretization the dual weighted residual vanishes
+     up to the newton tolerance and estimates nothing */
+  if ((algebraic_fraction > 0.0) && (! enrich_dual))
+    fail("algebraic error fraction requires dual enrichment");
   t_new = t_old + dt;
 }
 
@@ -78,6 +96,65 @@ static void change_p_globally(
   sol_info->project(mesh, false);
 }
 
+/* to first order the algebraic error in qoi i is z_i^T r for the
+   newton residual r. since |z_i^T r| <= ||z_i|| ||r||, and the
+   enriched dual vectors include the primal dofs, a newton residual
+   below fraction * eta_i / ||z_i|| for every qoi bounds each by the
+   given fraction of its estimated discretization error. the
+   estimates are lagged: those of this step set the newton and dual
+   linear tolerances of the next. */
+void SolverGoalContinuation::estimate_errors()
+{
+  double tol = 0.0;
+  double total = 0.0;
+  unsigned num_qois = mechanics->get_num_qois();
+  for (unsigned i=0; i < num_qois; ++i) {
+    double eta = error->estimate(i);
+    total += eta;
+    double z_norm = sol_info->owned_dual->getVector(i)->norm2();
+    if (z_norm <= 0.0) continue;
+    double t = algebraic_fraction * eta / z_norm;
+    if ((tol == 0.0) || (t < tol)) tol = t;
+  }
+  if (num_qois > 1)
+    print("estimated error summed over qois: %e", total);
+  if ((algebraic_fraction > 0.0) && (tol > 0.0)) {
+    primal->set_goal_tolerance(tol);
+    dual->set_goal_tolerance(tol);
+  }
+}
+
+/* every dual must be nonzero and, past the first, differ from the
+   first, so each qoi changes the dual that localizes the error. */
+static void check_duals(RCP<SolutionInfo> s)
+{
+  RCP<const MultiVector> z = s->owned_dual;
+  RCP<const Vector> z0 = z->getVector(0);
+  for (unsigned i=0; i < z->getNumVectors(); ++i) {
+    RCP<const Vector> zi = z->getVector(i);
+    Vector d(zi->getMap());
+    d.update(1.0, *zi, -1.0, *z0, 0.0);
+    double norm = zi->norm2();
+    double diff = d.norm2();
+    print("dual %u: ||z|| = %e, ||z - z_0|| = %e", i, norm, diff);
+    CHECK(norm > 0.0);
+    if (i > 0) CHECK(diff > 0.0);
+  }
+}
+
+static void check_regression(
+    RCP<const ParameterList> p,
+    RCP<SolutionInfo> s)
+{
+  double tol = p->get<double>("regression: tol");
+  double expected = p->get<double>("regression: val");
+  RCP<const Vector> x = s->owned_solution->getVector(0);
+  double computed = x->meanValue();
+  print("expected solution average: %.15f", expected);
+  print("computed solution average: %.15f", computed);
+  CHECK(std::abs(computed-expected) < tol);
+}
+
 void SolverGoalContinuation::solve()
 {
   sol_info->ovlp_solution->putScalar(0.0);
@@ -90,16 +167,28 @@ void SolverGoalContinuation::solve()
     print("** Primal problem");
     mechanics->build_primal();
     primal->set_time(t_new, t_old);
-    primal->solve();
+    if (! primal->solve())
+      fail("primal problem failed to converge");
 
     print("** Dual problem");
-    change_p_globally(+1, mesh, mechanics, sol_info);
-    mechanics->build_dual();
-    sol_info->create_dual_vectors(mesh);
+    if (enrich_dual)
+      change_p_globally(+1, mesh, mechanics, sol_info);
+    if (dual->reuses_primal_jacobian())
+      mechanics->build_qoi();
+    else
+      mechanics->build_dual();
+    sol_info->create_dual_vectors(mesh, mechanics->get_num_qois());
+    AttachInfo info = {mesh, mechanics, sol_info};
+    fill_duals_from_old_fields(info);
     dual->set_time(t_new, t_old);
     dual->solve();
+    if (params->isParameter("regression: distinct duals") &&
+        params->get<bool>("regression: distinct duals"))
+      check_duals(sol_info);
 
     print("** Error estimation");
+    if (enrich_dual)
+      estimate_errors();
     mechanics->build_error();
     error->set_time(t_new, t_old);
     error->localize();
@@ -107,13 +196,19 @@ void SolverGoalContinuation::solve()
     print("** Output");
     output->write(t_new);
 
+    /* the dual is carried as apf fields to warm start the next dual
+       solve, and is renumbered with the mesh */
+    attach_old_duals_to_shape(info);
     sol_info->destroy_dual_vectors();
-    change_p_globally(-1, mesh, mechanics, sol_info);
+    if (enrich_dual)
+      change_p_globally(-1, mesh, mechanics, sol_info);
 
     t_old = t_new;
     t_new = t_new + dt;
     mechanics->update_state();
   }
+  if (params->isParameter("regression: val"))
+    check_regression(params, sol_info);
 }
 
 }
@@ -31,6 +31,9 @@ class SolverGoalContinuation : public Solver
     double t_new;
     double dt;
     unsigned num_steps;
+    bool enrich_dual;
+    double algebraic_fraction;
+    void estimate_errors();
 };
 
 }
@@ -5,6 +5,7 @@
 #include "initial_condition.hpp"
 #include "primal_problem.hpp"
 #include "linear_solver.hpp"
+#include "update_history.hpp"
 #include "output.hpp"
 #include "assert_param.hpp"
 #include "control.hpp"
@@ -72,6 +73,8 @@ void SolverTrapezoid::solve()
   RCP<const ParameterList> p = rcpFromRef(params->sublist("linear algebra"));
   unsigned max_iters = p->get<unsigned>("nonlinear: max iters");
   double tolerance = p->get<double>("nonlinear: tolerance");
+  RCP<LinearSolver> linear_solver = rcp(new LinearSolver(p));
+  RCP<UpdateHistory> history = rcp(new UpdateHistory(p));
 
   /* get the solution information */
   RCP<Vector> u = sol_info->owned_solution->getVectorNonConst(0);
@@ -115,8 +118,10 @@ void SolverTrapezoid::solve()
       v->update(beta, *u, -beta, *u_v, 0.0);
       primal->compute_jacobian();
       r->scale(-1.0);
-      du->putScalar(0.0);
-      solve_linear_system(p, J, du, r);
+      history->guess(J, du, r);
+      linear_solver->set_coarse_map(mesh->get_vertex_map());
+      linear_solver->solve(J, du, r);
+      history->add(du);
       u->update(1.0, *du, 1.0);
       primal->compute_residual();
       double norm = r->norm2();
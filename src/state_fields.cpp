@@ -1,6 +1,7 @@
 #include "state_fields.hpp"
 #include "mesh.hpp"
 #include "control.hpp"
+#include "traits.hpp"
 
 #include <apf.h>
 #include <apfMesh2.h>
@@ -66,7 +67,8 @@ static double get_val(double v)
   return v;
 }
 
-static double get_val(FadType const& v)
+template <typename FadT>
+static double get_val(FadT const& v)
 {
   return v.val();
 }
@@ -207,18 +209,16 @@ void StateFields::update()
 }
 
 /* ETI */
-template void StateFields::set_scalar(char const* name, apf::MeshEntity* e, unsigned n, double const& v);
-template void StateFields::set_scalar(char const* name, apf::MeshEntity* e, unsigned n, FadType const& v);
-template void StateFields::set_vector(char const* name, apf::MeshEntity* e, unsigned n, Intrepid2::Vector<double> const& v);
-template void StateFields::set_vector(char const* name, apf::MeshEntity* e, unsigned n, Intrepid2::Vector<FadType> const& v);
-template void StateFields::set_tensor(char const* name, apf::MeshEntity* e, unsigned n, Intrepid2::Tensor<double> const& v);
-template void StateFields::set_tensor(char const* name, apf::MeshEntity* e, unsigned n, Intrepid2::Tensor<FadType> const& v);
-
-template void StateFields::get_scalar(char const* name, apf::MeshEntity* e, unsigned n, double& v);
-template void StateFields::get_scalar(char const* name, apf::MeshEntity* e, unsigned n, FadType& v);
-template void StateFields::get_vector(char const* name, apf::MeshEntity* e, unsigned n, Intrepid2::Vector<double>& v);
-template void StateFields::get_vector(char const* name, apf::MeshEntity* e, unsigned n, Intrepid2::Vector<FadType>& v);
-template void StateFields::get_tensor(char const* name, apf::MeshEntity* e, unsigned n, Intrepid2::Tensor<double>& v);
-template void StateFields::get_tensor(char const* name, apf::MeshEntity* e, unsigned n, Intrepid2::Tensor<FadType>& v);
+#define GOAL_STATE_FIELDS_ETI(T) \
+template void StateFields::set_scalar(char const* name, apf::MeshEntity* e, unsigned n, T const& v); \
+template void StateFields::set_vector(char const* name, apf::MeshEntity* e, unsigned n, Intrepid2::Vector<T> const& v); \
+template void StateFields::set_tensor(char const* name, apf::MeshEntity* e, unsigned n, Intrepid2::Tensor<T> const& v); \
+template void StateFields::get_scalar(char const* name, apf::MeshEntity* e, unsigned n, T& v); \
+template void StateFields::get_vector(char const* name, apf::MeshEntity* e, unsigned n, Intrepid2::Vector<T>& v); \
+template void StateFields::get_tensor(char const* name, apf::MeshEntity* e, unsigned n, Intrepid2::Tensor<T>& v);
+#define GOAL_STATE_FIELDS_EVAL_ETI(EvalT) GOAL_STATE_FIELDS_ETI(EvalT::ScalarT)
+
+GOAL_STATE_FIELDS_ETI(double)
+GOAL_FOR_EACH_DERIVATIVE(GOAL_STATE_FIELDS_EVAL_ETI)
 
 }
@@ -13,13 +13,28 @@ namespace goal {
 
 struct Workset;
 
+/* derivative arrays of exactly N entries, or of at most
+   GOAL_FAD_SIZE entries for the generic case N=0. */
+template <int N>
+struct DerivativeFad {typedef Sacado::Fad::SFad<double, N> type;};
+
+template <>
+struct DerivativeFad<0> {typedef Sacado::Fad::SLFad<double, GOAL_FAD_SIZE> type;};
+
 struct GoalTraits : public PHX::TraitsBase
 {
   typedef double RealType;
-  typedef Sacado::Fad::SLFad<RealType, GOAL_FAD_SIZE> FadType;
+  typedef DerivativeFad<0>::type FadType;
   struct Forward {typedef RealType ScalarT;};
-  struct Derivative {typedef FadType ScalarT;};
-  typedef Sacado::mpl::vector<Forward, Derivative> EvalTypes;
+  template <int N>
+  struct DerivativeN {typedef typename DerivativeFad<N>::type ScalarT;};
+  typedef DerivativeN<0> Derivative;
+  typedef Sacado::mpl::vector<
+    Forward,
+    Derivative,
+    DerivativeN<6>,
+    DerivativeN<12>,
+    DerivativeN<30> > EvalTypes;
   typedef void* SetupData;
   typedef Workset& PreEvalData;
   typedef Workset& PostEvalData;
@@ -37,11 +52,11 @@ struct eval_scalar_types<goal::GoalTraits::Forward>
     goal::GoalTraits::RealType> type;
 };
 
-template <>
-struct eval_scalar_types<goal::GoalTraits::Derivative>
+template <int N>
+struct eval_scalar_types<goal::GoalTraits::DerivativeN<N> >
 {
   typedef Sacado::mpl::vector<
-    goal::GoalTraits::FadType,
+    typename goal::GoalTraits::DerivativeN<N>::ScalarT,
     goal::GoalTraits::RealType> type;
 };
 
@@ -51,10 +66,38 @@ struct eval_scalar_types<goal::GoalTraits::Derivative>
   template class name<goal::GoalTraits::Forward, goal::GoalTraits>;
 
 #define GOAL_INSTANTIATE_DERIVATIVE(name) \
-  template class name<goal::GoalTraits::Derivative, goal::GoalTraits>;
+  template class name<goal::GoalTraits::Derivative, goal::GoalTraits>; \
+  template class name<goal::GoalTraits::DerivativeN<6>, goal::GoalTraits>; \
+  template class name<goal::GoalTraits::DerivativeN<12>, goal::GoalTraits>; \
+  template class name<goal::GoalTraits::DerivativeN<30>, goal::GoalTraits>;
 
 #define GOAL_INSTANTIATE_ALL(name) \
   GOAL_INSTANTIATE_FORWARD(name) \
   GOAL_INSTANTIATE_DERIVATIVE(name)
 
+/* expands MACRO(EvalT) for every derivative evaluation type, for
+   the explicit instantiation of functions templated on EvalT. */
+#define GOAL_FOR_EACH_DERIVATIVE(MACRO) \
+  MACRO(goal::GoalTraits::Derivative) \
+  MACRO(goal::GoalTraits::DerivativeN<6>) \
+  MACRO(goal::GoalTraits::DerivativeN<12>) \
+  MACRO(goal::GoalTraits::DerivativeN<30>)
+
+/* calls FUNC<D>(...) with the derivative evaluation type D whose
+   derivative array holds exactly NUM_DOFS entries. these are the
+   displacement dofs of the elements GOAL_DISPATCH_KERNEL specializes:
+   P1 and P2 triangles and tetrahedra. other element dof counts,
+   including those with a pressure field, use the GOAL_FAD_SIZE
+   fallback, so each exact size costs one more instantiation of every
+   evaluator only where the kernels are specialized too. */
+#define GOAL_DISPATCH_DERIVATIVE(NUM_DOFS, FUNC, ...) \
+  do { \
+    switch (NUM_DOFS) { \
+      case 6: FUNC<goal::GoalTraits::DerivativeN<6> >(__VA_ARGS__); break; \
+      case 12: FUNC<goal::GoalTraits::DerivativeN<12> >(__VA_ARGS__); break; \
+      case 30: FUNC<goal::GoalTraits::DerivativeN<30> >(__VA_ARGS__); break; \
+      default: FUNC<goal::GoalTraits::Derivative>(__VA_ARGS__); \
+    } \
+  } while (0)
+
 #endif
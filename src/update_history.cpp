@@ -0,0 +1,87 @@
+#include "update_history.hpp"
+#include "control.hpp"
+
+#include <Teuchos_ParameterList.hpp>
+
+#include <cmath>
+#include <algorithm>
+
+namespace goal {
+
+UpdateHistory::UpdateHistory(RCP<const ParameterList> p) :
+  size(0)
+{
+  if (p->isParameter("linear: guess history"))
+    size = p->get<unsigned>("linear: guess history");
+}
+
+void UpdateHistory::reset()
+{
+  updates.clear();
+  map = Teuchos::null;
+}
+
+void UpdateHistory::add(RCP<const Vector> x)
+{
+  if (size == 0) return;
+  if (x->getMap() != map) {
+    reset();
+    map = x->getMap();
+  }
+  RCP<Vector> v;
+  if (updates.size() < size)
+    v = rcp(new Vector(map));
+  else {
+    v = updates.front();
+    updates.pop_front();
+  }
+  v->assign(*x);
+  updates.push_back(v);
+}
+
+/* minimize ||b - A x|| over the span of the stored updates by
+   orthonormalizing their images under A with modified gram-schmidt. */
+void UpdateHistory::guess(
+    RCP<Matrix> A,
+    RCP<Vector> x,
+    RCP<const Vector> b)
+{
+  x->putScalar(0.0);
+  if (updates.size() == 0) return;
+  if (x->getMap() != map) {
+    reset();
+    return;
+  }
+  double t0 = time();
+  double b_norm = b->norm2();
+  double r_norm2 = b_norm*b_norm;
+  std::vector<RCP<Vector> > v;
+  std::vector<RCP<Vector> > w;
+  for (unsigned i=0; i < updates.size(); ++i) {
+    RCP<Vector> vi = rcp(new Vector(map));
+    RCP<Vector> wi = rcp(new Vector(map));
+    vi->assign(*(updates[i]));
+    A->apply(*vi, *wi);
+    double w_norm = wi->norm2();
+    for (unsigned j=0; j < w.size(); ++j) {
+      double r = w[j]->dot(*wi);
+      wi->update(-r, *(w[j]), 1.0);
+      vi->update(-r, *(v[j]), 1.0);
+    }
+    double n = wi->norm2();
+    if (n <= 1.0e-10*w_norm) continue;
+    wi->scale(1.0/n);
+    vi->scale(1.0/n);
+    double c = wi->dot(*b);
+    x->update(c, *vi, 1.0);
+    r_norm2 -= c*c;
+    v.push_back(vi);
+    w.push_back(wi);
+  }
+  double t1 = time();
+  print("  initial guess from %u updates reduced ||b|| from %e to %e",
+      (unsigned)w.size(), b_norm, std::sqrt(std::max(r_norm2, 0.0)));
+  print("  initial guess computed in %f seconds", t1-t0);
+}
+
+}
@@ -0,0 +1,36 @@
+#ifndef goal_update_history_hpp
+#define goal_update_history_hpp
+
+#include "data_types.hpp"
+
+#include <deque>
+
+namespace goal {
+
+using Teuchos::rcp;
+using Teuchos::RCP;
+using Teuchos::ParameterList;
+
+class UpdateHistory
+{
+  public:
+
+    UpdateHistory(RCP<const ParameterList> p);
+
+    void guess(RCP<Matrix> A, RCP<Vector> x, RCP<const Vector> b);
+
+    void add(RCP<const Vector> x);
+
+    void reset();
+
+  private:
+
+    unsigned size;
+    RCP<const Map> map;
+    std::deque<RCP<Vector> > updates;
+
+};
+
+}
+
+#endif
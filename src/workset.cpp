@@ -5,6 +5,7 @@ namespace goal {
 Workset::Workset() :
   size(0),
   set(""),
+  ws_idx(0),
   t_new(0.0),
   t_old(0.0),
   alpha(0.0),
@@ -17,6 +17,7 @@ struct Workset
   Workset();
   unsigned size;
   std::string set;
+  unsigned ws_idx;
   double t_new;
   double t_old;
   RCP<MultiVector> u;
@@ -27,8 +28,8 @@ struct Workset
   double gamma;
   std::vector<apf::MeshEntity*> ents;
   bool is_adjoint;
-  RCP<Vector> z;
-  RCP<Vector> q;
+  RCP<MultiVector> z;
+  RCP<MultiVector> q;
 };
 
 }